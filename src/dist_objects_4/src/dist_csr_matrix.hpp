@@ -0,0 +1,339 @@
+//  Copyright (c) 2019 Weile Wei
+//  Copyright (c) 2019 Maxwell Reeser
+//  Copyright (c) 2019 Hartmut Kaiser
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#if !defined(HPX_DIST_CSR_MATRIX_OCT_16_2019_0400PM)
+#define HPX_DIST_CSR_MATRIX_OCT_16_2019_0400PM
+
+#include "server/dist_csr_matrix.hpp"
+#include "template_dist_object.hpp"
+
+#include <hpx/include/components.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/include/parallel_for_each.hpp>
+#include <hpx/util/assert.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The dist_csr_matrix is a sparse matrix distributed by blocks of rows.
+// Locality l owns the rows [row_offsets[l], row_offsets[l + 1]) and, for
+// multiply, the same entries of the vectors x and y. At construction every
+// locality works out which entries of x owned by others its rows refer to
+// and tells their owners, which keep that list. Each multiply then only
+// exchanges exactly those ghost values, one message per pair of localities
+// sharing any, while the rows referring to local entries only are computed
+// in the meantime. Requires REGISTER_DIST_CSR_MATRIX(type)
+namespace dist_object {
+	template <typename T>
+	class dist_csr_matrix
+		: hpx::components::client_base<dist_csr_matrix<T>,
+			server::dist_csr_matrix_part<T>> {
+		typedef server::dist_csr_matrix_part<T> server_type;
+		typedef hpx::components::client_base<dist_csr_matrix<T>,
+			server_type> base_type;
+
+	public:
+		typedef std::vector<T> vector_type;
+
+		dist_csr_matrix() {}
+
+		// row_ptr, cols and values hold the local rows in CSR form, with
+		// global column indices. row_offsets has to be the same on all
+		// localities, and this has to be called on all of them
+		dist_csr_matrix(std::string base,
+			std::vector<std::size_t> const& row_offsets,
+			std::vector<std::size_t> row_ptr,
+			std::vector<std::size_t> const& cols, vector_type values)
+			: base_(base), plan_(std::make_shared<receive_plan>()),
+			  iteration_(std::make_shared<std::atomic<std::uint64_t>>(0))
+		{
+			num_localities_ = hpx::find_all_localities().size();
+			std::size_t const here = hpx::get_locality_id();
+			HPX_ASSERT(row_offsets.size() == num_localities_ + 1);
+			std::size_t const first_row = row_offsets[here];
+			std::size_t const num_rows = row_offsets[here + 1] - first_row;
+			HPX_ASSERT(row_ptr.size() == num_rows + 1);
+			plan_->first_row = first_row;
+			plan_->num_rows = num_rows;
+
+			// the remote entries of x referred to, by owner
+			std::vector<std::vector<std::size_t>> ghosts(num_localities_);
+			for (std::size_t col : cols) {
+				std::size_t const loc = owner_of(row_offsets, col);
+				if (loc != here)
+					ghosts[loc].push_back(col);
+			}
+
+			// the ghost values follow the local entries of x, grouped by
+			// owner and sorted by column
+			std::vector<std::size_t> ghost_offsets(num_localities_, 0);
+			std::size_t end = num_rows;
+			for (std::size_t loc = 0; loc != num_localities_; ++loc) {
+				std::vector<std::size_t>& g = ghosts[loc];
+				std::sort(g.begin(), g.end());
+				g.erase(std::unique(g.begin(), g.end()), g.end());
+				if (g.empty())
+					continue;
+				ghost_offsets[loc] = end;
+				plan_->sources.push_back(source{loc, end, g.size()});
+				end += g.size();
+			}
+			plan_->num_entries = end;
+
+			std::vector<std::size_t> local_cols(cols.size());
+			for (std::size_t k = 0; k != cols.size(); ++k) {
+				std::size_t const loc = owner_of(row_offsets, cols[k]);
+				if (loc == here) {
+					local_cols[k] = cols[k] - first_row;
+				}
+				else {
+					std::vector<std::size_t> const& g = ghosts[loc];
+					local_cols[k] = ghost_offsets[loc] + static_cast<std::size_t>(
+						std::lower_bound(g.begin(), g.end(), cols[k]) - g.begin());
+				}
+			}
+
+			for (std::size_t r = 0; r != num_rows; ++r) {
+				bool boundary = false;
+				for (std::size_t k = row_ptr[r]; k != row_ptr[r + 1]; ++k)
+					boundary = boundary || local_cols[k] >= num_rows;
+				(boundary ? plan_->boundary_rows : plan_->interior_rows)
+					.push_back(r);
+			}
+
+			static_cast<base_type&>(*this) = base_type(hpx::new_<server_type>(
+				hpx::find_here(), num_localities_, std::move(row_ptr),
+				std::move(local_cols), std::move(values)));
+			hpx::register_with_basename(base_ + std::to_string(here),
+				this->get_id());
+			ids_ = std::make_shared<detail::id_cache>(num_localities_);
+			ids_->set(here, this->get_id());
+
+			// tell every other locality which of its entries are needed here,
+			// all of them have to know how many requests to wait for
+			typedef typename server_type::request_ghosts_action action_type;
+			std::vector<hpx::future<void>> requests;
+			requests.reserve(num_localities_);
+			for (std::size_t loc = 0; loc != num_localities_; ++loc) {
+				if (loc == here)
+					continue;
+				std::vector<std::size_t> entries(ghosts[loc]);
+				for (std::size_t& e : entries)
+					e -= row_offsets[loc];
+				requests.push_back(async_on<action_type>(loc, here, entries));
+			}
+			setup_ = hpx::when_all(requests).then(hpx::launch::sync,
+				[](hpx::future<std::vector<hpx::future<void>>> f)
+				{
+					for (hpx::future<void>& r : f.get())
+						r.get();
+				});
+		}
+
+		// Global index of the first local row and number of local rows
+		std::size_t first_row() const { return plan_->first_row; }
+		std::size_t num_rows() const { return plan_->num_rows; }
+
+		// Number of entries of x owned by other localities which are needed
+		// here in every multiply
+		std::size_t num_ghosts() const
+		{
+			return plan_->num_entries - plan_->num_rows;
+		}
+
+		// y = A x, x_local holds the entries of x owned by this locality and
+		// the returned future the ones of y. Has to be called on all
+		// localities, in the same order
+		hpx::future<vector_type> multiply(vector_type const& x_local)
+		{
+			HPX_ASSERT(this->get_id());
+			HPX_ASSERT(x_local.size() == plan_->num_rows);
+			ensure_ptr();
+			std::uint64_t const iteration = (*iteration_)++;
+			std::size_t const here = hpx::get_locality_id();
+
+			std::shared_ptr<vector_type> x =
+				std::make_shared<vector_type>(plan_->num_entries);
+			std::copy(x_local.begin(), x_local.end(), x->begin());
+			std::shared_ptr<vector_type> y =
+				std::make_shared<vector_type>(plan_->num_rows, T());
+
+			// send the entries the others asked for, once all of them did
+			typedef typename server_type::deposit_ghosts_action action_type;
+			dist_csr_matrix self(*this);
+			hpx::future<void> sent = hpx::when_all(ptr->plan_ready(), setup_)
+				.then([self, x, iteration, here](hpx::future<hpx::util::tuple<
+					hpx::shared_future<void>, hpx::shared_future<void>>> f)
+					mutable
+				{
+					auto ready = f.get();
+					hpx::util::get<0>(ready).get();
+					hpx::util::get<1>(ready).get();
+
+					std::vector<hpx::future<void>> sends;
+					for (std::size_t loc = 0; loc != self.num_localities_;
+						++loc)
+					{
+						std::vector<std::size_t> const& list =
+							self.ptr->send_list(loc);
+						if (list.empty())
+							continue;
+						vector_type values(list.size());
+						for (std::size_t i = 0; i != list.size(); ++i)
+							values[i] = (*x)[list[i]];
+						sends.push_back(self.template async_on<action_type>(
+							loc, make_tag(iteration, here), values));
+					}
+					return hpx::when_all(sends).then(hpx::launch::sync,
+						[](hpx::future<std::vector<hpx::future<void>>> s)
+						{
+							for (hpx::future<void>& r : s.get())
+								r.get();
+						});
+				});
+
+			std::vector<hpx::future<void>> received;
+			received.reserve(plan_->sources.size());
+			for (source const& s : plan_->sources) {
+				received.push_back(ptr->receive_ghosts(
+					make_tag(iteration, s.loc)).then(hpx::launch::sync,
+					[x, s](hpx::future<vector_type> f)
+					{
+						vector_type values = f.get();
+						HPX_ASSERT(values.size() == s.count);
+						std::copy(values.begin(), values.end(),
+							x->begin() + s.offset);
+					}));
+			}
+
+			// rows referring to local entries only do not wait for the
+			// exchange
+			std::shared_ptr<receive_plan const> plan = plan_;
+			std::shared_ptr<server_type> a = ptr;
+			hpx::future<void> interior = hpx::async(
+				[plan, a, x, y]()
+				{
+					multiply_rows(*a, plan->interior_rows, *x, *y);
+				});
+
+			return hpx::dataflow(
+				[plan, a, x, y](
+					hpx::future<std::vector<hpx::future<void>>> r,
+					hpx::future<void> interior, hpx::future<void> sent)
+				{
+					for (hpx::future<void>& f : r.get())
+						f.get();
+					interior.get();
+					multiply_rows(*a, plan->boundary_rows, *x, *y);
+					sent.get();
+					return std::move(*y);
+				},
+				hpx::when_all(received), std::move(interior), std::move(sent));
+		}
+
+		hpx::future<vector_type> multiply(dist_object<vector_type>& x)
+		{
+			return multiply(*x);
+		}
+
+	private:
+		// Ghost values received from loc are placed at x[offset, offset +
+		// count)
+		struct source {
+			std::size_t loc;
+			std::size_t offset;
+			std::size_t count;
+		};
+
+		struct receive_plan {
+			std::size_t first_row = 0;
+			std::size_t num_rows = 0;
+			// local entries of x followed by all ghost values
+			std::size_t num_entries = 0;
+			std::vector<source> sources;
+			std::vector<std::size_t> interior_rows;
+			std::vector<std::size_t> boundary_rows;
+		};
+
+		static std::size_t owner_of(std::vector<std::size_t> const& row_offsets,
+			std::size_t row)
+		{
+			HPX_ASSERT(row < row_offsets.back());
+			return static_cast<std::size_t>(std::upper_bound(row_offsets.begin(),
+				row_offsets.end(), row) - row_offsets.begin()) - 1;
+		}
+
+		static std::uint64_t make_tag(std::uint64_t iteration,
+			std::size_t sender)
+		{
+			return (iteration << 32) | sender;
+		}
+
+		static void multiply_rows(server_type const& a,
+			std::vector<std::size_t> const& rows, vector_type const& x,
+			vector_type& y)
+		{
+			std::vector<std::size_t> const& row_ptr = a.row_ptr();
+			std::vector<std::size_t> const& cols = a.cols();
+			vector_type const& values = a.values();
+			hpx::parallel::for_each(hpx::parallel::execution::par,
+				rows.begin(), rows.end(),
+				[&](std::size_t r)
+				{
+					T sum = T();
+					for (std::size_t k = row_ptr[r]; k != row_ptr[r + 1]; ++k)
+						sum += values[k] * x[cols[k]];
+					y[r] = sum;
+				});
+		}
+
+		hpx::shared_future<hpx::id_type> get_id_helper(std::size_t loc)
+		{
+			HPX_ASSERT(ids_);
+			std::string const& base = base_;
+			return ids_->get(loc, [&base, loc]() {
+				return hpx::find_from_basename(base + std::to_string(loc), loc);
+			});
+		}
+
+		template <typename Action, typename... Ts>
+		auto async_on(std::size_t loc, Ts const&... vs)
+			-> decltype(hpx::async<Action>(std::declval<hpx::id_type>(), vs...))
+		{
+			hpx::shared_future<hpx::id_type> id = get_id_helper(loc);
+			if (id.is_ready())
+				return hpx::async<Action>(id.get(), vs...);
+			return id.then(
+				[=](hpx::shared_future<hpx::id_type> f)
+				{
+					return hpx::async<Action>(f.get(), vs...);
+				});
+		}
+
+		void ensure_ptr() const {
+			if (!ptr) {
+				ptr = hpx::get_ptr<server_type>(hpx::launch::sync,
+					this->get_id());
+			}
+		}
+
+		mutable std::shared_ptr<server_type> ptr;
+		std::shared_ptr<detail::id_cache> ids_;
+		std::string base_;
+		std::size_t num_localities_ = 0;
+		std::shared_ptr<receive_plan> plan_;
+		std::shared_ptr<std::atomic<std::uint64_t>> iteration_;
+		hpx::shared_future<void> setup_;
+	};
+}
+#endif
@@ -0,0 +1,344 @@
+//  Copyright (c) 2019 Weile Wei
+//  Copyright (c) 2019 Maxwell Reeser
+//  Copyright (c) 2019 Hartmut Kaiser
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#if !defined(HPX_DIST_MATRIX_OCT_16_2019_1130AM)
+#define HPX_DIST_MATRIX_OCT_16_2019_1130AM
+
+#include "server/dist_matrix.hpp"
+#include "template_dist_object.hpp"
+
+#include <hpx/include/components.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/include/parallel_for_each.hpp>
+#include <hpx/util/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The dist_matrix splits a rows x cols matrix into tiles of tile_rows x
+// tile_cols elements (the ones in the last tile row and column may be
+// smaller) and distributes them 2D block-cyclic over a grid_rows x
+// grid_cols grid of localities: tile (I, J) is owned by the locality at
+// grid position (I mod grid_rows, J mod grid_cols), locality l sits at grid
+// position (l / grid_cols, l mod grid_cols). Each tile is one contiguous
+// buffer in the order given by Layout, see tile. Tiles are fetched and put
+// as a whole. Requires REGISTER_DIST_MATRIX(type, layout)
+namespace dist_object {
+	template <typename T, typename Layout = row_major>
+	class dist_matrix
+		: hpx::components::client_base<dist_matrix<T, Layout>,
+			server::dist_matrix_part<T, Layout>> {
+		typedef server::dist_matrix_part<T, Layout> server_type;
+		typedef hpx::components::client_base<dist_matrix<T, Layout>,
+			server_type> base_type;
+
+	public:
+		typedef tile<T, Layout> tile_type;
+
+		dist_matrix() {}
+
+		// Creates the tiles owned by this locality, all elements set to
+		// init. Has to be called on all localities with the same arguments,
+		// grid_rows * grid_cols has to match the number of localities
+		dist_matrix(std::string base, std::size_t rows, std::size_t cols,
+			std::size_t tile_rows, std::size_t tile_cols,
+			std::size_t grid_rows, std::size_t grid_cols, T const& init = T())
+			: base_(base), rows_(rows), cols_(cols),
+			  tile_rows_(tile_rows), tile_cols_(tile_cols),
+			  grid_rows_(grid_rows), grid_cols_(grid_cols)
+		{
+			HPX_ASSERT(tile_rows != 0 && tile_cols != 0);
+			HPX_ASSERT(grid_rows * grid_cols ==
+				hpx::find_all_localities().size());
+
+			std::size_t const here = hpx::get_locality_id();
+			std::size_t const my_row = here / grid_cols_;
+			std::size_t const my_col = here % grid_cols_;
+			std::vector<tile_type> tiles;
+			tiles.reserve(local_tile_rows(my_row) * local_tile_cols(my_col));
+			for (std::size_t I = my_row; I < num_tile_rows(); I += grid_rows_) {
+				for (std::size_t J = my_col; J < num_tile_cols();
+					J += grid_cols_)
+				{
+					tiles.emplace_back(tile_rows_of(I), tile_cols_of(J), init);
+				}
+			}
+			static_cast<base_type&>(*this) = base_type(
+				hpx::new_<server_type>(hpx::find_here(), std::move(tiles)));
+
+			hpx::register_with_basename(base_ + std::to_string(here),
+				this->get_id());
+			ids_ = std::make_shared<detail::id_cache>(grid_rows_ * grid_cols_);
+			ids_->set(here, this->get_id());
+		}
+
+		std::size_t rows() const { return rows_; }
+		std::size_t cols() const { return cols_; }
+		std::size_t grid_rows() const { return grid_rows_; }
+		std::size_t grid_cols() const { return grid_cols_; }
+
+		std::size_t num_tile_rows() const
+		{
+			return (rows_ + tile_rows_ - 1) / tile_rows_;
+		}
+
+		std::size_t num_tile_cols() const
+		{
+			return (cols_ + tile_cols_ - 1) / tile_cols_;
+		}
+
+		// Dimensions of the tiles in tile row I and tile column J
+		std::size_t tile_rows_of(std::size_t I) const
+		{
+			HPX_ASSERT(I < num_tile_rows());
+			return (std::min)(tile_rows_, rows_ - I * tile_rows_);
+		}
+
+		std::size_t tile_cols_of(std::size_t J) const
+		{
+			HPX_ASSERT(J < num_tile_cols());
+			return (std::min)(tile_cols_, cols_ - J * tile_cols_);
+		}
+
+		// Global index of the first row (column) of tile row I (column J)
+		std::size_t first_row_of(std::size_t I) const
+		{
+			return I * tile_rows_;
+		}
+
+		std::size_t first_col_of(std::size_t J) const
+		{
+			return J * tile_cols_;
+		}
+
+		// Locality owning the tile (I, J)
+		std::size_t owner(std::size_t I, std::size_t J) const
+		{
+			HPX_ASSERT(I < num_tile_rows() && J < num_tile_cols());
+			return (I % grid_rows_) * grid_cols_ + J % grid_cols_;
+		}
+
+		bool is_local(std::size_t I, std::size_t J) const
+		{
+			return owner(I, J) == hpx::get_locality_id();
+		}
+
+		// The tile (I, J), which has to be owned by this locality
+		tile_type& local_tile(std::size_t I, std::size_t J)
+		{
+			HPX_ASSERT(is_local(I, J));
+			ensure_ptr();
+			return ptr->local_tile(local_index(I, J));
+		}
+
+		tile_type const& local_tile(std::size_t I, std::size_t J) const
+		{
+			HPX_ASSERT(is_local(I, J));
+			ensure_ptr();
+			return ptr->local_tile(local_index(I, J));
+		}
+
+		// Copies the tile (I, J), local tiles are returned right away
+		hpx::future<tile_type> fetch_tile(std::size_t I, std::size_t J)
+		{
+			HPX_ASSERT(this->get_id());
+			std::size_t const loc = owner(I, J);
+			std::size_t const idx = local_index(I, J);
+			if (loc == hpx::get_locality_id()) {
+				ensure_ptr();
+				return hpx::make_ready_future(ptr->fetch_tile(idx));
+			}
+
+			typedef typename server_type::fetch_tile_action action_type;
+			return get_id_helper(loc).then(
+				[idx](hpx::shared_future<hpx::id_type> f)
+				{
+					return hpx::async<action_type>(f.get(), idx);
+				});
+		}
+
+		// Overwrites the tile (I, J), value has to have its dimensions
+		hpx::future<void> put_tile(std::size_t I, std::size_t J,
+			tile_type const& value)
+		{
+			HPX_ASSERT(this->get_id());
+			std::size_t const loc = owner(I, J);
+			std::size_t const idx = local_index(I, J);
+			if (loc == hpx::get_locality_id()) {
+				ensure_ptr();
+				ptr->put_tile(idx, value);
+				return hpx::make_ready_future();
+			}
+
+			typedef typename server_type::put_tile_action action_type;
+			return get_id_helper(loc).then(
+				[idx, value](hpx::shared_future<hpx::id_type> f)
+				{
+					return hpx::async<action_type>(f.get(), idx, value);
+				});
+		}
+
+	private:
+		// Number of tile rows (columns) owned by the localities in the given
+		// grid row (column)
+		std::size_t local_tile_rows(std::size_t grid_row) const
+		{
+			return grid_row < num_tile_rows() ?
+				(num_tile_rows() - grid_row + grid_rows_ - 1) / grid_rows_ : 0;
+		}
+
+		std::size_t local_tile_cols(std::size_t grid_col) const
+		{
+			return grid_col < num_tile_cols() ?
+				(num_tile_cols() - grid_col + grid_cols_ - 1) / grid_cols_ : 0;
+		}
+
+		// Position of the tile (I, J) among the tiles of its owner, which
+		// are stored row by row
+		std::size_t local_index(std::size_t I, std::size_t J) const
+		{
+			return (I / grid_rows_) * local_tile_cols(J % grid_cols_) +
+				J / grid_cols_;
+		}
+
+		hpx::shared_future<hpx::id_type> get_id_helper(std::size_t loc)
+		{
+			HPX_ASSERT(ids_);
+			std::string const& base = base_;
+			return ids_->get(loc, [&base, loc]() {
+				return hpx::find_from_basename(base + std::to_string(loc), loc);
+			});
+		}
+
+		void ensure_ptr() const {
+			if (!ptr) {
+				ptr = hpx::get_ptr<server_type>(hpx::launch::sync,
+					this->get_id());
+			}
+		}
+
+		mutable std::shared_ptr<server_type> ptr;
+		std::shared_ptr<detail::id_cache> ids_;
+		std::string base_;
+		std::size_t rows_ = 0;
+		std::size_t cols_ = 0;
+		std::size_t tile_rows_ = 1;
+		std::size_t tile_cols_ = 1;
+		std::size_t grid_rows_ = 1;
+		std::size_t grid_cols_ = 1;
+	};
+
+	// c += a * b with SUMMA: in step k, every locality multiplies tile
+	// column k of a and tile row k of b into its own tiles of c. The tiles of
+	// column k it needs live in its grid row, the ones of row k in its grid
+	// column, so each tile of a (b) is received by grid_cols (grid_rows)
+	// localities, and a locality only ever holds lookahead panels besides
+	// its own tiles. The panels of the next lookahead steps are fetched while
+	// the current one is multiplied, the tile products of a step run in
+	// parallel. The three matrices have to use the same grid, the tiling of
+	// the rows of b has to match the one of the columns of a. Has to be
+	// called on all localities once a and b are complete, c is complete once
+	// it returned on all of them
+	template <typename T, typename Layout>
+	void summa(dist_matrix<T, Layout>& c, dist_matrix<T, Layout>& a,
+		dist_matrix<T, Layout>& b, std::size_t lookahead = 2)
+	{
+		typedef tile<T, Layout> tile_type;
+
+		HPX_ASSERT(a.rows() == c.rows() && b.cols() == c.cols() &&
+			a.cols() == b.rows());
+		HPX_ASSERT(a.grid_rows() == c.grid_rows() &&
+			b.grid_rows() == c.grid_rows());
+		HPX_ASSERT(a.grid_cols() == c.grid_cols() &&
+			b.grid_cols() == c.grid_cols());
+		HPX_ASSERT(a.num_tile_cols() == b.num_tile_rows());
+
+		std::size_t const here = hpx::get_locality_id();
+		std::vector<std::size_t> my_rows, my_cols;
+		for (std::size_t I = here / c.grid_cols(); I < c.num_tile_rows();
+			I += c.grid_rows())
+		{
+			HPX_ASSERT(a.tile_rows_of(I) == c.tile_rows_of(I));
+			my_rows.push_back(I);
+		}
+		for (std::size_t J = here % c.grid_cols(); J < c.num_tile_cols();
+			J += c.grid_cols())
+		{
+			HPX_ASSERT(b.tile_cols_of(J) == c.tile_cols_of(J));
+			my_cols.push_back(J);
+		}
+
+		// the tile products of a step: the tile of c and the positions of
+		// the tiles of a and b in the panels
+		struct product {
+			tile_type* c;
+			std::size_t i;
+			std::size_t j;
+		};
+		std::vector<product> products;
+		products.reserve(my_rows.size() * my_cols.size());
+		for (std::size_t i = 0; i != my_rows.size(); ++i) {
+			for (std::size_t j = 0; j != my_cols.size(); ++j) {
+				products.push_back(
+					product{&c.local_tile(my_rows[i], my_cols[j]), i, j});
+			}
+		}
+
+		struct panels {
+			std::vector<hpx::future<tile_type>> a;
+			std::vector<hpx::future<tile_type>> b;
+		};
+
+		auto fetch_panels = [&](std::size_t k)
+		{
+			HPX_ASSERT(a.tile_cols_of(k) == b.tile_rows_of(k));
+			panels p;
+			p.a.reserve(my_rows.size());
+			for (std::size_t I : my_rows)
+				p.a.push_back(a.fetch_tile(I, k));
+			p.b.reserve(my_cols.size());
+			for (std::size_t J : my_cols)
+				p.b.push_back(b.fetch_tile(k, J));
+			return p;
+		};
+
+		std::size_t const steps = a.num_tile_cols();
+		lookahead = (std::max)(lookahead, std::size_t(1));
+
+		std::deque<panels> in_flight;
+		for (std::size_t k = 0; k != (std::min)(lookahead, steps); ++k)
+			in_flight.push_back(fetch_panels(k));
+
+		for (std::size_t k = 0; k != steps; ++k) {
+			panels p = std::move(in_flight.front());
+			in_flight.pop_front();
+			if (k + lookahead < steps)
+				in_flight.push_back(fetch_panels(k + lookahead));
+
+			std::vector<tile_type> a_panel, b_panel;
+			a_panel.reserve(p.a.size());
+			for (hpx::future<tile_type>& f : p.a)
+				a_panel.push_back(f.get());
+			b_panel.reserve(p.b.size());
+			for (hpx::future<tile_type>& f : p.b)
+				b_panel.push_back(f.get());
+
+			hpx::parallel::for_each(hpx::parallel::execution::par,
+				products.begin(), products.end(),
+				[&](product const& prod)
+				{
+					multiply_add(*prod.c, a_panel[prod.i], b_panel[prod.j]);
+				});
+		}
+	}
+}
+#endif
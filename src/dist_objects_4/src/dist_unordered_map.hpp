@@ -0,0 +1,275 @@
+//  Copyright (c) 2019 Weile Wei
+//  Copyright (c) 2019 Maxwell Reeser
+//  Copyright (c) 2019 Hartmut Kaiser
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#if !defined(HPX_DIST_UNORDERED_MAP_OCT_16_2019_0230PM)
+#define HPX_DIST_UNORDERED_MAP_OCT_16_2019_0230PM
+
+#include "server/dist_unordered_map.hpp"
+#include "template_dist_object.hpp"
+
+#include <hpx/include/components.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/util/assert.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The dist_unordered_map is a hash map spread over all localities. Each
+// locality holds one shard, a key is stored on the locality its hash maps
+// to. find, insert and update address a single key, the multi_ variants
+// take many keys and send all keys owned by the same locality with a single
+// action, which is what bulk workloads should use. Entries owned by this
+// locality are accessed directly. Requires
+// REGISTER_DIST_UNORDERED_MAP(key, value)
+namespace dist_object {
+	template <typename K, typename V>
+	class dist_unordered_map
+		: hpx::components::client_base<dist_unordered_map<K, V>,
+			server::dist_unordered_map_shard<K, V>> {
+		typedef server::dist_unordered_map_shard<K, V> server_type;
+		typedef hpx::components::client_base<dist_unordered_map<K, V>,
+			server_type> base_type;
+
+	public:
+		typedef K key_type;
+		typedef V mapped_type;
+		typedef find_result<V> result_type;
+
+		dist_unordered_map() {}
+
+		// Creates the shard of this locality, has to be called on all
+		// localities
+		explicit dist_unordered_map(std::string base)
+			: base_type(hpx::new_<server_type>(hpx::find_here())), base_(base)
+		{
+			std::size_t const here = hpx::get_locality_id();
+			hpx::register_with_basename(base_ + std::to_string(here),
+				this->get_id());
+			num_localities_ = hpx::find_all_localities().size();
+			ids_ = std::make_shared<detail::id_cache>(num_localities_);
+			ids_->set(here, this->get_id());
+		}
+
+		// Locality owning the given key. The hash is mixed first, so that
+		// the keys of one shard do not all fall into the same residue class
+		// of its own buckets
+		std::size_t owner(K const& key) const
+		{
+			std::uint64_t h = static_cast<std::uint64_t>(std::hash<K>()(key));
+			h *= 0x9e3779b97f4a7c15ull;
+			return static_cast<std::size_t>((h >> 32) % num_localities_);
+		}
+
+		hpx::future<result_type> find(K const& key)
+		{
+			std::size_t const loc = owner(key);
+			if (loc == hpx::get_locality_id())
+				return hpx::make_ready_future(local().find(key));
+
+			typedef typename server_type::find_action action_type;
+			return async_on<action_type>(loc, key);
+		}
+
+		// Adds the entry unless the key is present already, the future holds
+		// whether it was added
+		hpx::future<bool> insert(K const& key, V const& value)
+		{
+			std::size_t const loc = owner(key);
+			if (loc == hpx::get_locality_id())
+				return hpx::make_ready_future(local().insert(key, value));
+
+			typedef typename server_type::insert_action action_type;
+			return async_on<action_type>(loc, key, value);
+		}
+
+		// Adds the entry or replaces the value of an existing one, the future
+		// holds whether the key was present
+		hpx::future<bool> update(K const& key, V const& value)
+		{
+			std::size_t const loc = owner(key);
+			if (loc == hpx::get_locality_id())
+				return hpx::make_ready_future(local().update(key, value));
+
+			typedef typename server_type::update_action action_type;
+			return async_on<action_type>(loc, key, value);
+		}
+
+		// Looks up all keys with one action per owning locality, the results
+		// are in the order of keys
+		hpx::future<std::vector<result_type>> multi_find(
+			std::vector<K> const& keys)
+		{
+			typedef typename server_type::multi_find_action action_type;
+			std::shared_ptr<batches> b = make_batches(keys);
+
+			std::vector<hpx::future<std::vector<result_type>>> replies;
+			replies.reserve(num_localities_);
+			for (std::size_t loc = 0; loc != num_localities_; ++loc) {
+				if (b->keys[loc].empty()) {
+					replies.push_back(
+						hpx::make_ready_future(std::vector<result_type>()));
+				}
+				else if (loc == hpx::get_locality_id()) {
+					replies.push_back(hpx::make_ready_future(
+						local().multi_find(b->keys[loc])));
+				}
+				else {
+					replies.push_back(
+						async_on<action_type>(loc, b->keys[loc]));
+				}
+			}
+
+			std::size_t const count = keys.size();
+			return hpx::when_all(replies).then(hpx::launch::sync,
+				[b, count](hpx::future<std::vector<
+					hpx::future<std::vector<result_type>>>> f)
+				{
+					std::vector<hpx::future<std::vector<result_type>>>
+						replies = f.get();
+					std::vector<result_type> result(count);
+					for (std::size_t loc = 0; loc != replies.size(); ++loc) {
+						std::vector<result_type> found = replies[loc].get();
+						std::vector<std::size_t> const& pos = b->positions[loc];
+						HPX_ASSERT(found.size() == pos.size());
+						for (std::size_t i = 0; i != pos.size(); ++i)
+							result[pos[i]] = std::move(found[i]);
+					}
+					return result;
+				});
+		}
+
+		// Inserts all entries with one action per owning locality, the
+		// future holds the number of entries which were added
+		hpx::future<std::size_t> multi_insert(std::vector<K> const& keys,
+			std::vector<V> const& values)
+		{
+			HPX_ASSERT(keys.size() == values.size());
+			typedef typename server_type::multi_insert_action action_type;
+			std::shared_ptr<batches> b = make_batches(keys);
+
+			std::vector<hpx::future<std::size_t>> replies;
+			replies.reserve(num_localities_);
+			for (std::size_t loc = 0; loc != num_localities_; ++loc) {
+				if (b->keys[loc].empty())
+					continue;
+
+				std::vector<V> batch_values;
+				batch_values.reserve(b->positions[loc].size());
+				for (std::size_t pos : b->positions[loc])
+					batch_values.push_back(values[pos]);
+
+				if (loc == hpx::get_locality_id()) {
+					replies.push_back(hpx::make_ready_future(
+						local().multi_insert(b->keys[loc], batch_values)));
+				}
+				else {
+					replies.push_back(async_on<action_type>(loc, b->keys[loc],
+						batch_values));
+				}
+			}
+
+			return hpx::when_all(replies).then(hpx::launch::sync,
+				[](hpx::future<std::vector<hpx::future<std::size_t>>> f)
+				{
+					std::size_t added = 0;
+					for (hpx::future<std::size_t>& r : f.get())
+						added += r.get();
+					return added;
+				});
+		}
+
+		// Number of entries in the shard of this locality
+		std::size_t local_size() const
+		{
+			return local().size();
+		}
+
+		// Number of entries in all shards
+		hpx::future<std::size_t> size()
+		{
+			typedef typename server_type::size_action action_type;
+			std::vector<hpx::future<std::size_t>> sizes;
+			sizes.reserve(num_localities_);
+			for (std::size_t loc = 0; loc != num_localities_; ++loc)
+				sizes.push_back(async_on<action_type>(loc));
+
+			return hpx::when_all(sizes).then(hpx::launch::sync,
+				[](hpx::future<std::vector<hpx::future<std::size_t>>> f)
+				{
+					std::size_t total = 0;
+					for (hpx::future<std::size_t>& s : f.get())
+						total += s.get();
+					return total;
+				});
+		}
+
+	private:
+		// The keys of a batched request grouped by owner, together with
+		// their positions in the request
+		struct batches {
+			explicit batches(std::size_t n) : keys(n), positions(n) {}
+
+			std::vector<std::vector<K>> keys;
+			std::vector<std::vector<std::size_t>> positions;
+		};
+
+		std::shared_ptr<batches> make_batches(std::vector<K> const& keys) const
+		{
+			std::shared_ptr<batches> b =
+				std::make_shared<batches>(num_localities_);
+			for (std::size_t i = 0; i != keys.size(); ++i) {
+				std::size_t const loc = owner(keys[i]);
+				b->keys[loc].push_back(keys[i]);
+				b->positions[loc].push_back(i);
+			}
+			return b;
+		}
+
+		server_type& local() const
+		{
+			if (!ptr) {
+				ptr = hpx::get_ptr<server_type>(hpx::launch::sync,
+					this->get_id());
+			}
+			return *ptr;
+		}
+
+		hpx::shared_future<hpx::id_type> get_id_helper(std::size_t loc)
+		{
+			HPX_ASSERT(ids_);
+			std::string const& base = base_;
+			return ids_->get(loc, [&base, loc]() {
+				return hpx::find_from_basename(base + std::to_string(loc), loc);
+			});
+		}
+
+		template <typename Action, typename... Ts>
+		auto async_on(std::size_t loc, Ts const&... vs)
+			-> decltype(hpx::async<Action>(std::declval<hpx::id_type>(), vs...))
+		{
+			hpx::shared_future<hpx::id_type> id = get_id_helper(loc);
+			if (id.is_ready())
+				return hpx::async<Action>(id.get(), vs...);
+			return id.then(
+				[=](hpx::shared_future<hpx::id_type> f)
+				{
+					return hpx::async<Action>(f.get(), vs...);
+				});
+		}
+
+		mutable std::shared_ptr<server_type> ptr;
+		std::shared_ptr<detail::id_cache> ids_;
+		std::string base_;
+		std::size_t num_localities_ = 0;
+	};
+}
+#endif
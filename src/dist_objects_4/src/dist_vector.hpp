@@ -0,0 +1,254 @@
+//  Copyright (c) 2019 Weile Wei
+//  Copyright (c) 2019 Maxwell Reeser
+//  Copyright (c) 2019 Hartmut Kaiser
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#if !defined(HPX_DIST_VECTOR_OCT_16_2019_1015AM)
+#define HPX_DIST_VECTOR_OCT_16_2019_1015AM
+
+#include "template_dist_object.hpp"
+
+#include <hpx/include/lcos.hpp>
+#include <hpx/util/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// The distribution decides which locality owns an element of a dist_vector.
+// The elements are dealt out in blocks of block_size consecutive indices,
+// round robin over the localities. The blocks owned by a locality are stored
+// back to back in its partition, in the order of their global indices.
+namespace dist_object {
+	class distribution {
+	public:
+		distribution()
+			: block_size_(0), size_(0), num_localities_(0) {}
+
+		// One contiguous block of (nearly) equal size per locality
+		static distribution block()
+		{
+			return distribution(0);
+		}
+
+		// Consecutive elements on consecutive localities
+		static distribution cyclic()
+		{
+			return distribution(1);
+		}
+
+		static distribution block_cyclic(std::size_t block_size)
+		{
+			HPX_ASSERT(block_size != 0);
+			return distribution(block_size);
+		}
+
+		// Fixes the number of elements and localities the mapping is for
+		distribution bind(std::size_t size, std::size_t num_localities) const
+		{
+			HPX_ASSERT(num_localities != 0);
+			distribution result(block_size_);
+			result.size_ = size;
+			result.num_localities_ = num_localities;
+			if (result.block_size_ == 0) {
+				result.block_size_ = (std::max)(std::size_t(1),
+					(size + num_localities - 1) / num_localities);
+			}
+			return result;
+		}
+
+		std::size_t size() const { return size_; }
+		std::size_t block_size() const { return block_size_; }
+		std::size_t num_localities() const { return num_localities_; }
+
+		// Locality owning the element with the given global index
+		std::size_t owner(std::size_t i) const
+		{
+			HPX_ASSERT(i < size_);
+			return (i / block_size_) % num_localities_;
+		}
+
+		// Position of the element with the given global index in the
+		// partition of its owner
+		std::size_t local_index(std::size_t i) const
+		{
+			HPX_ASSERT(i < size_);
+			std::size_t const blk = i / block_size_;
+			return (blk / num_localities_) * block_size_ + i % block_size_;
+		}
+
+		// Global index of the element at the given position in the partition
+		// of the given locality
+		std::size_t global_index(std::size_t loc, std::size_t local) const
+		{
+			std::size_t const blk =
+				(local / block_size_) * num_localities_ + loc;
+			return blk * block_size_ + local % block_size_;
+		}
+
+		// Number of blocks owned by the given locality
+		std::size_t num_blocks(std::size_t loc) const
+		{
+			std::size_t const blocks = (size_ + block_size_ - 1) / block_size_;
+			return loc < blocks ?
+				(blocks - loc + num_localities_ - 1) / num_localities_ : 0;
+		}
+
+		// Number of elements owned by the given locality, only the last
+		// block may be cut short
+		std::size_t local_size(std::size_t loc) const
+		{
+			std::size_t const n = num_blocks(loc);
+			if (n == 0)
+				return 0;
+			std::size_t const last = (loc + (n - 1) * num_localities_) *
+				block_size_;
+			return (n - 1) * block_size_ + (std::min)(block_size_, size_ - last);
+		}
+
+	private:
+		explicit distribution(std::size_t block_size)
+			: block_size_(block_size), size_(0), num_localities_(0) {}
+
+		std::size_t block_size_;
+		std::size_t size_;
+		std::size_t num_localities_;
+	};
+}
+
+// The dist_vector is a vector whose elements are spread over all localities
+// according to a distribution. Every locality stores the elements it owns in
+// one dist_object<std::vector<T>> partition. Elements are addressed by their global index,
+// accessing an element owned by another locality yields a future. For bulk
+// work on the local elements, segments() exposes them as contiguous ranges
+// which can be handed to the parallel algorithms directly, e.g.
+//
+//     for (auto& seg : v.segments())
+//         hpx::parallel::for_each(hpx::parallel::execution::par,
+//             seg.begin(), seg.end(), f);
+//
+// which touches no remote data. Requires REGISTER_DIST_OBJECT_PART and
+// REGISTER_DIST_OBJECT_PART_RANGE for std::vector<T>
+namespace dist_object {
+	template <typename T, typename Policy = shared_read_policy>
+	class dist_vector {
+	public:
+		typedef T value_type;
+		typedef std::vector<T> data_type;
+		typedef dist_object<data_type, construction_type::All_to_All, Policy>
+			partition_type;
+
+		// A block of consecutive global indices owned by this locality
+		class segment {
+		public:
+			segment(std::size_t first, T* data, std::size_t count)
+				: first_(first), data_(data), count_(count) {}
+
+			// Global index of the first element
+			std::size_t first() const { return first_; }
+			std::size_t size() const { return count_; }
+
+			T* begin() const { return data_; }
+			T* end() const { return data_ + count_; }
+
+		private:
+			std::size_t first_;
+			T* data_;
+			std::size_t count_;
+		};
+
+		dist_vector() {}
+
+		// Has to be called on all localities with the same arguments
+		dist_vector(std::string base, std::size_t size,
+			distribution dist = distribution::block(), T const& init = T())
+			: dist_(dist.bind(size, hpx::find_all_localities().size())),
+			  here_(hpx::get_locality_id()),
+			  part_(base, data_type(dist_.local_size(here_), init))
+		{}
+
+		std::size_t size() const
+		{
+			return dist_.size();
+		}
+
+		distribution const& get_distribution() const
+		{
+			return dist_;
+		}
+
+		bool is_local(std::size_t i) const
+		{
+			return dist_.owner(i) == here_;
+		}
+
+		// Reads the element with the given global index, elements owned by
+		// this locality are returned right away
+		hpx::future<T> get(std::size_t i)
+		{
+			std::size_t const loc = dist_.owner(i);
+			std::size_t const offset = dist_.local_index(i);
+			if (loc == here_)
+				return hpx::make_ready_future((*part_)[offset]);
+
+			return part_.fetch(static_cast<int>(loc), offset, 1).then(
+				hpx::launch::sync,
+				[](hpx::future<data_type> f)
+				{
+					return f.get()[0];
+				});
+		}
+
+		hpx::future<T> operator[](std::size_t i)
+		{
+			return get(i);
+		}
+
+		// Overwrites the element with the given global index
+		hpx::future<void> set(std::size_t i, T const& value)
+		{
+			std::size_t const loc = dist_.owner(i);
+			std::size_t const offset = dist_.local_index(i);
+			if (loc == here_) {
+				(*part_)[offset] = value;
+				return hpx::make_ready_future();
+			}
+
+			return part_.put(static_cast<int>(loc), offset,
+				data_type(1, value));
+		}
+
+		// The elements owned by this locality, one segment per block
+		std::vector<segment> segments()
+		{
+			std::size_t const blocks = dist_.num_blocks(here_);
+			std::size_t const block_size = dist_.block_size();
+			T* data = part_->data();
+			std::size_t const count = part_->size();
+
+			std::vector<segment> result;
+			result.reserve(blocks);
+			for (std::size_t b = 0; b != blocks; ++b) {
+				std::size_t const offset = b * block_size;
+				result.emplace_back(dist_.global_index(here_, offset),
+					data + offset, (std::min)(block_size, count - offset));
+			}
+			return result;
+		}
+
+		// The partition holding the elements of this locality
+		partition_type& partition()
+		{
+			return part_;
+		}
+
+	private:
+		distribution dist_;
+		std::size_t here_ = 0;
+		partition_type part_;
+	};
+}
+#endif
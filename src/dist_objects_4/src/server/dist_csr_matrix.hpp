@@ -0,0 +1,146 @@
+// Copyright (c) 2019 Weile Wei
+// Copyright (c) 2019 Maxwell Reeser
+// Copyright (c) 2019 Hartmut Kaiser
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#if !defined(HPX_DIST_CSR_MATRIX_SERVER_OCT_16_2019_0400PM)
+#define HPX_DIST_CSR_MATRIX_SERVER_OCT_16_2019_0400PM
+
+#include "template_dist_object.hpp"
+
+#include <hpx/include/actions.hpp>
+#include <hpx/include/components.hpp>
+#include <hpx/lcos/local/promise.hpp>
+#include <hpx/lcos/local/spinlock.hpp>
+#include <hpx/runtime/serialization/serialize.hpp>
+#include <hpx/runtime/serialization/vector.hpp>
+#include <hpx/util/assert.hpp>
+#include <hpx/util/detail/pp/cat.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// The server of a dist_csr_matrix holds the row block of one locality in
+// CSR form, with the column indices already mapped to positions in the
+// local part of x followed by the ghost values received from the other
+// localities. It also holds the send half of the communication plan: for
+// each other locality, the local entries of x it needs in every multiply.
+namespace dist_object {
+namespace server {
+template <typename T>
+class dist_csr_matrix_part
+    : public hpx::components::component_base<dist_csr_matrix_part<T>> {
+public:
+  typedef std::vector<T> vector_type;
+
+  dist_csr_matrix_part() : pending_(0) {}
+
+  dist_csr_matrix_part(std::size_t num_localities,
+                       std::vector<std::size_t> &&row_ptr,
+                       std::vector<std::size_t> &&cols, vector_type &&values)
+      : row_ptr_(std::move(row_ptr)), cols_(std::move(cols)),
+        values_(std::move(values)), send_lists_(num_localities),
+        pending_(num_localities - 1), plan_ready_(plan_promise_.get_future()) {
+    HPX_ASSERT(!row_ptr_.empty() && row_ptr_.back() == cols_.size());
+    HPX_ASSERT(cols_.size() == values_.size());
+    if (pending_ == 0)
+      plan_promise_.set_value();
+  }
+
+  std::size_t num_rows() const { return row_ptr_.size() - 1; }
+  std::vector<std::size_t> const &row_ptr() const { return row_ptr_; }
+  std::vector<std::size_t> const &cols() const { return cols_; }
+  vector_type const &values() const { return values_; }
+
+  // The local entries of x the given locality needs, only valid once
+  // plan_ready is
+  std::vector<std::size_t> const &send_list(std::size_t loc) const {
+    return send_lists_[loc];
+  }
+
+  // Becomes ready once every other locality has told which entries it needs
+  hpx::shared_future<void> plan_ready() const { return plan_ready_; }
+
+  // Setup: requester needs the given (local) entries of x in every multiply.
+  // Each other locality calls this exactly once, possibly with no entries
+  void request_ghosts(std::size_t requester,
+                      std::vector<std::size_t> const &entries) {
+    bool complete = false;
+    {
+      std::lock_guard<hpx::lcos::local::spinlock> l(mtx_);
+      HPX_ASSERT(requester < send_lists_.size() && pending_ != 0);
+      send_lists_[requester] = entries;
+      complete = --pending_ == 0;
+    }
+    if (complete)
+      plan_promise_.set_value();
+  }
+
+  // The ghost values of one multiply, tagged with the multiply and sender
+  void deposit_ghosts(std::uint64_t tag, vector_type const &values) {
+    mailbox_.deposit(tag, values);
+  }
+
+  hpx::future<vector_type> receive_ghosts(std::uint64_t tag) {
+    return mailbox_.receive(tag);
+  }
+
+  HPX_DEFINE_COMPONENT_ACTION(dist_csr_matrix_part, request_ghosts);
+  HPX_DEFINE_COMPONENT_ACTION(dist_csr_matrix_part, deposit_ghosts);
+
+private:
+  std::vector<std::size_t> row_ptr_;
+  std::vector<std::size_t> cols_;
+  vector_type values_;
+
+  hpx::lcos::local::spinlock mtx_;
+  std::vector<std::vector<std::size_t>> send_lists_;
+  std::size_t pending_;
+  hpx::lcos::local::promise<void> plan_promise_;
+  hpx::shared_future<void> plan_ready_;
+
+  detail::mailbox<vector_type> mailbox_;
+};
+} // namespace server
+} // namespace dist_object
+
+// Every element type in use has to be registered, e.g.
+// REGISTER_DIST_CSR_MATRIX(double)
+#define DIST_CSR_MATRIX_PART_TYPE(type)                                       \
+  HPX_PP_CAT(__dist_csr_matrix_part_type_, type)
+/**/
+
+#define DIST_CSR_MATRIX_PART_TYPEDEF(type)                                    \
+  typedef dist_object::server::dist_csr_matrix_part<type>                     \
+      DIST_CSR_MATRIX_PART_TYPE(type);
+/**/
+
+#define REGISTER_DIST_CSR_MATRIX_DECLARATION(type)                            \
+  DIST_CSR_MATRIX_PART_TYPEDEF(type)                                          \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_CSR_MATRIX_PART_TYPE(type)::request_ghosts_action,                 \
+      HPX_PP_CAT(__dist_csr_matrix_part_request_ghosts_action_, type));       \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_CSR_MATRIX_PART_TYPE(type)::deposit_ghosts_action,                 \
+      HPX_PP_CAT(__dist_csr_matrix_part_deposit_ghosts_action_, type));       \
+  /**/
+
+#define REGISTER_DIST_CSR_MATRIX(type)                                        \
+  DIST_CSR_MATRIX_PART_TYPEDEF(type)                                          \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_CSR_MATRIX_PART_TYPE(type)::request_ghosts_action,                 \
+      HPX_PP_CAT(__dist_csr_matrix_part_request_ghosts_action_, type));       \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_CSR_MATRIX_PART_TYPE(type)::deposit_ghosts_action,                 \
+      HPX_PP_CAT(__dist_csr_matrix_part_deposit_ghosts_action_, type));       \
+  typedef ::hpx::components::component<DIST_CSR_MATRIX_PART_TYPE(type)>      \
+      HPX_PP_CAT(__dist_csr_matrix_part_, type);                              \
+  HPX_REGISTER_COMPONENT(HPX_PP_CAT(__dist_csr_matrix_part_, type))           \
+  /**/
+
+#endif
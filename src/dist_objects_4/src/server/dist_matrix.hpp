@@ -0,0 +1,314 @@
+// Copyright (c) 2019 Weile Wei
+// Copyright (c) 2019 Maxwell Reeser
+// Copyright (c) 2019 Hartmut Kaiser
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#if !defined(HPX_DIST_MATRIX_SERVER_OCT_16_2019_1130AM)
+#define HPX_DIST_MATRIX_SERVER_OCT_16_2019_1130AM
+
+#include "template_dist_object.hpp"
+
+#include <hpx/include/actions.hpp>
+#include <hpx/include/components.hpp>
+#include <hpx/runtime/serialization/array.hpp>
+#include <hpx/runtime/serialization/serialize.hpp>
+#include <hpx/util/assert.hpp>
+#include <hpx/util/detail/pp/cat.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Storage orders of a tile, selected at compile time
+namespace dist_object {
+struct row_major {
+  static std::size_t index(std::size_t i, std::size_t j, std::size_t rows,
+                           std::size_t cols) {
+    return i * cols + j;
+  }
+};
+
+struct column_major {
+  static std::size_t index(std::size_t i, std::size_t j, std::size_t rows,
+                           std::size_t cols) {
+    return j * rows + i;
+  }
+};
+} // namespace dist_object
+
+namespace dist_object {
+namespace detail {
+// Allocator handing out memory aligned to Alignment bytes, so the elements
+// of a tile start on a cache line and the vectorized kernels can use
+// aligned loads
+template <typename T, std::size_t Alignment = 64> class aligned_allocator {
+  static_assert((Alignment & (Alignment - 1)) == 0,
+                "Alignment has to be a power of two");
+
+public:
+  typedef T value_type;
+  typedef T *pointer;
+  typedef T const *const_pointer;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <typename U> struct rebind {
+    typedef aligned_allocator<U, Alignment> other;
+  };
+
+  aligned_allocator() noexcept {}
+
+  template <typename U>
+  aligned_allocator(aligned_allocator<U, Alignment> const &) noexcept {}
+
+  // Over-allocates and keeps the address returned by operator new right in
+  // front of the aligned block
+  pointer allocate(size_type n, void const * = nullptr) {
+    void *raw = ::operator new(n * sizeof(T) + Alignment + sizeof(void *));
+    std::uintptr_t const first =
+        reinterpret_cast<std::uintptr_t>(raw) + sizeof(void *);
+    std::uintptr_t const aligned =
+        (first + Alignment - 1) & ~static_cast<std::uintptr_t>(Alignment - 1);
+    reinterpret_cast<void **>(aligned)[-1] = raw;
+    return reinterpret_cast<pointer>(aligned);
+  }
+
+  void deallocate(pointer p, size_type) noexcept {
+    ::operator delete(reinterpret_cast<void **>(p)[-1]);
+  }
+
+  friend bool operator==(aligned_allocator const &,
+                         aligned_allocator const &) noexcept {
+    return true;
+  }
+
+  friend bool operator!=(aligned_allocator const &,
+                         aligned_allocator const &) noexcept {
+    return false;
+  }
+};
+} // namespace detail
+} // namespace dist_object
+
+// A dense rows x cols block of a dist_matrix, stored in a single aligned
+// buffer in the order given by Layout. It is serialized as one contiguous
+// chunk of elements, without any per-row overhead.
+namespace dist_object {
+template <typename T, typename Layout = row_major> class tile {
+public:
+  typedef T value_type;
+  typedef Layout layout_type;
+  typedef std::vector<T, detail::aligned_allocator<T>> storage_type;
+
+  tile() : rows_(0), cols_(0) {}
+
+  tile(std::size_t rows, std::size_t cols, T const &init = T())
+      : rows_(rows), cols_(cols), data_(rows * cols, init) {}
+
+  std::size_t rows() const { return rows_; }
+  std::size_t cols() const { return cols_; }
+  std::size_t size() const { return data_.size(); }
+
+  T *data() { return data_.data(); }
+  T const *data() const { return data_.data(); }
+
+  T &operator()(std::size_t i, std::size_t j) {
+    HPX_ASSERT(i < rows_ && j < cols_);
+    return data_[Layout::index(i, j, rows_, cols_)];
+  }
+
+  T const &operator()(std::size_t i, std::size_t j) const {
+    HPX_ASSERT(i < rows_ && j < cols_);
+    return data_[Layout::index(i, j, rows_, cols_)];
+  }
+
+  // Element-wise kernels run over the contiguous storage, independent of
+  // the layout
+  tile &operator+=(tile const &rhs) {
+    HPX_ASSERT(rows_ == rhs.rows_ && cols_ == rhs.cols_);
+    T *__restrict lhs_data = data_.data();
+    T const *__restrict rhs_data = rhs.data_.data();
+    std::size_t const n = data_.size();
+    for (std::size_t k = 0; k != n; ++k)
+      lhs_data[k] += rhs_data[k];
+    return *this;
+  }
+
+  tile &operator*=(T const &factor) {
+    T *__restrict d = data_.data();
+    std::size_t const n = data_.size();
+    for (std::size_t k = 0; k != n; ++k)
+      d[k] *= factor;
+    return *this;
+  }
+
+  friend bool operator==(tile const &lhs, tile const &rhs) {
+    return lhs.rows_ == rhs.rows_ && lhs.cols_ == rhs.cols_ &&
+           std::equal(lhs.data_.begin(), lhs.data_.end(), rhs.data_.begin());
+  }
+
+  friend bool operator!=(tile const &lhs, tile const &rhs) {
+    return !(lhs == rhs);
+  }
+
+private:
+  friend class hpx::serialization::access;
+
+  template <typename Archive> void load(Archive &ar, unsigned int const) {
+    ar >> rows_ >> cols_;
+    data_.resize(rows_ * cols_);
+    ar >> hpx::serialization::make_array(data_.data(), data_.size());
+  }
+
+  template <typename Archive> void save(Archive &ar, unsigned int const) const {
+    ar << rows_ << cols_;
+    ar << hpx::serialization::make_array(data_.data(), data_.size());
+  }
+
+  HPX_SERIALIZATION_SPLIT_MEMBER()
+
+  std::size_t rows_;
+  std::size_t cols_;
+  storage_type data_;
+};
+
+namespace detail {
+// The loop orders keep the innermost loop on unit stride for both c and b
+template <typename T>
+void multiply_add(tile<T, row_major> &c, tile<T, row_major> const &a,
+                  tile<T, row_major> const &b) {
+  std::size_t const m = c.rows(), n = c.cols(), l = a.cols();
+  T *__restrict cd = c.data();
+  T const *__restrict ad = a.data();
+  T const *__restrict bd = b.data();
+  for (std::size_t i = 0; i != m; ++i) {
+    for (std::size_t k = 0; k != l; ++k) {
+      T const aik = ad[i * l + k];
+      for (std::size_t j = 0; j != n; ++j)
+        cd[i * n + j] += aik * bd[k * n + j];
+    }
+  }
+}
+
+template <typename T>
+void multiply_add(tile<T, column_major> &c, tile<T, column_major> const &a,
+                  tile<T, column_major> const &b) {
+  std::size_t const m = c.rows(), n = c.cols(), l = a.cols();
+  T *__restrict cd = c.data();
+  T const *__restrict ad = a.data();
+  T const *__restrict bd = b.data();
+  for (std::size_t j = 0; j != n; ++j) {
+    for (std::size_t k = 0; k != l; ++k) {
+      T const bkj = bd[j * l + k];
+      for (std::size_t i = 0; i != m; ++i)
+        cd[j * m + i] += ad[k * m + i] * bkj;
+    }
+  }
+}
+} // namespace detail
+
+// c += a * b
+template <typename T, typename Layout>
+void multiply_add(tile<T, Layout> &c, tile<T, Layout> const &a,
+                  tile<T, Layout> const &b) {
+  HPX_ASSERT(a.rows() == c.rows() && b.cols() == c.cols() &&
+             a.cols() == b.rows());
+  detail::multiply_add(c, a, b);
+}
+} // namespace dist_object
+
+// The server of a dist_matrix holds the tiles owned by one locality, in the
+// order of their local tile indices, and serves tile requests of the others
+namespace dist_object {
+namespace server {
+template <typename T, typename Layout = row_major>
+class dist_matrix_part
+    : public hpx::components::component_base<dist_matrix_part<T, Layout>> {
+  typedef shared_read_policy::read_lock read_lock;
+  typedef shared_read_policy::write_lock write_lock;
+
+public:
+  typedef tile<T, Layout> tile_type;
+
+  dist_matrix_part() {}
+
+  dist_matrix_part(std::vector<tile_type> &&tiles)
+      : tiles_(std::move(tiles)) {}
+
+  std::size_t num_tiles() const { return tiles_.size(); }
+
+  // Direct access for the owning locality
+  tile_type &local_tile(std::size_t idx) {
+    HPX_ASSERT(idx < tiles_.size());
+    return tiles_[idx];
+  }
+
+  tile_type fetch_tile(std::size_t idx) const {
+    read_lock l(mtx_);
+    HPX_ASSERT(idx < tiles_.size());
+    return tiles_[idx];
+  }
+
+  void put_tile(std::size_t idx, tile_type const &value) {
+    write_lock l(mtx_);
+    HPX_ASSERT(idx < tiles_.size());
+    HPX_ASSERT(tiles_[idx].rows() == value.rows() &&
+               tiles_[idx].cols() == value.cols());
+    tiles_[idx] = value;
+  }
+
+  HPX_DEFINE_COMPONENT_ACTION(dist_matrix_part, fetch_tile);
+  HPX_DEFINE_COMPONENT_ACTION(dist_matrix_part, put_tile);
+
+private:
+  mutable shared_read_policy::mutex_type mtx_;
+  std::vector<tile_type> tiles_;
+};
+} // namespace server
+} // namespace dist_object
+
+// Every combination of element type and layout in use has to be registered,
+// e.g. REGISTER_DIST_MATRIX(double, row_major)
+#define DIST_MATRIX_PART_TYPE(type, layout)                                   \
+  HPX_PP_CAT(__dist_matrix_part_type_, HPX_PP_CAT(type, layout))
+/**/
+
+#define DIST_MATRIX_PART_TYPEDEF(type, layout)                                \
+  typedef dist_object::server::dist_matrix_part<type, dist_object::layout>    \
+      DIST_MATRIX_PART_TYPE(type, layout);
+/**/
+
+#define REGISTER_DIST_MATRIX_DECLARATION(type, layout)                        \
+  DIST_MATRIX_PART_TYPEDEF(type, layout)                                      \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_MATRIX_PART_TYPE(type, layout)::fetch_tile_action,                 \
+      HPX_PP_CAT(__dist_matrix_part_fetch_tile_action_,                       \
+                 HPX_PP_CAT(type, layout)));                                  \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_MATRIX_PART_TYPE(type, layout)::put_tile_action,                   \
+      HPX_PP_CAT(__dist_matrix_part_put_tile_action_,                         \
+                 HPX_PP_CAT(type, layout)));                                  \
+  /**/
+
+#define REGISTER_DIST_MATRIX(type, layout)                                    \
+  DIST_MATRIX_PART_TYPEDEF(type, layout)                                      \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_MATRIX_PART_TYPE(type, layout)::fetch_tile_action,                 \
+      HPX_PP_CAT(__dist_matrix_part_fetch_tile_action_,                       \
+                 HPX_PP_CAT(type, layout)));                                  \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_MATRIX_PART_TYPE(type, layout)::put_tile_action,                   \
+      HPX_PP_CAT(__dist_matrix_part_put_tile_action_,                         \
+                 HPX_PP_CAT(type, layout)));                                  \
+  typedef ::hpx::components::component<DIST_MATRIX_PART_TYPE(type, layout)>  \
+      HPX_PP_CAT(__dist_matrix_part_, HPX_PP_CAT(type, layout));              \
+  HPX_REGISTER_COMPONENT(                                                     \
+      HPX_PP_CAT(__dist_matrix_part_, HPX_PP_CAT(type, layout)))              \
+  /**/
+
+#endif
@@ -0,0 +1,177 @@
+// Copyright (c) 2019 Weile Wei
+// Copyright (c) 2019 Maxwell Reeser
+// Copyright (c) 2019 Hartmut Kaiser
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#if !defined(HPX_DIST_UNORDERED_MAP_SERVER_OCT_16_2019_0230PM)
+#define HPX_DIST_UNORDERED_MAP_SERVER_OCT_16_2019_0230PM
+
+#include "template_dist_object.hpp"
+
+#include <hpx/include/actions.hpp>
+#include <hpx/include/components.hpp>
+#include <hpx/runtime/serialization/serialize.hpp>
+#include <hpx/runtime/serialization/vector.hpp>
+#include <hpx/util/assert.hpp>
+#include <hpx/util/detail/pp/cat.hpp>
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Result of a lookup in a dist_unordered_map, value is only meaningful if
+// the key was found
+namespace dist_object {
+template <typename V> struct find_result {
+  find_result() : found(false), value() {}
+
+  explicit find_result(V const &v) : found(true), value(v) {}
+
+  bool found;
+  V value;
+
+  template <typename Archive> void serialize(Archive &ar, unsigned int const) {
+    ar & found & value;
+  }
+};
+} // namespace dist_object
+
+// The server of a dist_unordered_map holds the shard of one locality: the
+// entries whose keys hash to it. The batched actions handle all keys a
+// requester has for this shard with a single lock acquisition
+namespace dist_object {
+namespace server {
+template <typename K, typename V>
+class dist_unordered_map_shard
+    : public hpx::components::component_base<dist_unordered_map_shard<K, V>> {
+  typedef shared_read_policy::read_lock read_lock;
+  typedef shared_read_policy::write_lock write_lock;
+
+public:
+  typedef find_result<V> result_type;
+
+  std::size_t size() const {
+    read_lock l(mtx_);
+    return data_.size();
+  }
+
+  result_type find(K const &key) const {
+    read_lock l(mtx_);
+    auto it = data_.find(key);
+    return it == data_.end() ? result_type() : result_type(it->second);
+  }
+
+  // Adds the entry unless the key is present already, returns whether it
+  // was added
+  bool insert(K const &key, V const &value) {
+    write_lock l(mtx_);
+    return data_.emplace(key, value).second;
+  }
+
+  // Adds the entry or replaces the value of an existing one, returns
+  // whether the key was present
+  bool update(K const &key, V const &value) {
+    write_lock l(mtx_);
+    auto it = data_.find(key);
+    if (it == data_.end()) {
+      data_.emplace(key, value);
+      return false;
+    }
+    it->second = value;
+    return true;
+  }
+
+  std::vector<result_type> multi_find(std::vector<K> const &keys) const {
+    std::vector<result_type> result;
+    result.reserve(keys.size());
+    read_lock l(mtx_);
+    for (K const &key : keys) {
+      auto it = data_.find(key);
+      result.push_back(it == data_.end() ? result_type()
+                                         : result_type(it->second));
+    }
+    return result;
+  }
+
+  // Returns the number of entries which were added
+  std::size_t multi_insert(std::vector<K> const &keys,
+                           std::vector<V> const &values) {
+    HPX_ASSERT(keys.size() == values.size());
+    std::size_t added = 0;
+    write_lock l(mtx_);
+    data_.reserve(data_.size() + keys.size());
+    for (std::size_t i = 0; i != keys.size(); ++i) {
+      if (data_.emplace(keys[i], values[i]).second)
+        ++added;
+    }
+    return added;
+  }
+
+  HPX_DEFINE_COMPONENT_ACTION(dist_unordered_map_shard, size);
+  HPX_DEFINE_COMPONENT_ACTION(dist_unordered_map_shard, find);
+  HPX_DEFINE_COMPONENT_ACTION(dist_unordered_map_shard, insert);
+  HPX_DEFINE_COMPONENT_ACTION(dist_unordered_map_shard, update);
+  HPX_DEFINE_COMPONENT_ACTION(dist_unordered_map_shard, multi_find);
+  HPX_DEFINE_COMPONENT_ACTION(dist_unordered_map_shard, multi_insert);
+
+private:
+  mutable shared_read_policy::mutex_type mtx_;
+  std::unordered_map<K, V> data_;
+};
+} // namespace server
+} // namespace dist_object
+
+// Every combination of key and value type in use has to be registered, e.g.
+// REGISTER_DIST_UNORDERED_MAP(int, double)
+#define DIST_UNORDERED_MAP_SHARD_TYPE(key, value)                             \
+  HPX_PP_CAT(__dist_unordered_map_shard_type_, HPX_PP_CAT(key, value))
+/**/
+
+#define DIST_UNORDERED_MAP_SHARD_TYPEDEF(key, value)                          \
+  typedef dist_object::server::dist_unordered_map_shard<key, value>           \
+      DIST_UNORDERED_MAP_SHARD_TYPE(key, value);
+/**/
+
+#define REGISTER_DIST_UNORDERED_MAP_ACTION_DECLARATION(key, value, name)      \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_UNORDERED_MAP_SHARD_TYPE(key, value)::HPX_PP_CAT(name, _action),   \
+      HPX_PP_CAT(HPX_PP_CAT(__dist_unordered_map_shard_, name),               \
+                 HPX_PP_CAT(_action_, HPX_PP_CAT(key, value))));
+/**/
+
+#define REGISTER_DIST_UNORDERED_MAP_ACTION(key, value, name)                  \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_UNORDERED_MAP_SHARD_TYPE(key, value)::HPX_PP_CAT(name, _action),   \
+      HPX_PP_CAT(HPX_PP_CAT(__dist_unordered_map_shard_, name),               \
+                 HPX_PP_CAT(_action_, HPX_PP_CAT(key, value))));
+/**/
+
+#define REGISTER_DIST_UNORDERED_MAP_DECLARATION(key, value)                   \
+  DIST_UNORDERED_MAP_SHARD_TYPEDEF(key, value)                                \
+  REGISTER_DIST_UNORDERED_MAP_ACTION_DECLARATION(key, value, size)            \
+  REGISTER_DIST_UNORDERED_MAP_ACTION_DECLARATION(key, value, find)            \
+  REGISTER_DIST_UNORDERED_MAP_ACTION_DECLARATION(key, value, insert)          \
+  REGISTER_DIST_UNORDERED_MAP_ACTION_DECLARATION(key, value, update)          \
+  REGISTER_DIST_UNORDERED_MAP_ACTION_DECLARATION(key, value, multi_find)      \
+  REGISTER_DIST_UNORDERED_MAP_ACTION_DECLARATION(key, value, multi_insert)    \
+  /**/
+
+#define REGISTER_DIST_UNORDERED_MAP(key, value)                               \
+  DIST_UNORDERED_MAP_SHARD_TYPEDEF(key, value)                                \
+  REGISTER_DIST_UNORDERED_MAP_ACTION(key, value, size)                        \
+  REGISTER_DIST_UNORDERED_MAP_ACTION(key, value, find)                        \
+  REGISTER_DIST_UNORDERED_MAP_ACTION(key, value, insert)                      \
+  REGISTER_DIST_UNORDERED_MAP_ACTION(key, value, update)                      \
+  REGISTER_DIST_UNORDERED_MAP_ACTION(key, value, multi_find)                  \
+  REGISTER_DIST_UNORDERED_MAP_ACTION(key, value, multi_insert)                \
+  typedef ::hpx::components::component<DIST_UNORDERED_MAP_SHARD_TYPE(        \
+      key, value)>                                                            \
+      HPX_PP_CAT(__dist_unordered_map_shard_, HPX_PP_CAT(key, value));        \
+  HPX_REGISTER_COMPONENT(                                                     \
+      HPX_PP_CAT(__dist_unordered_map_shard_, HPX_PP_CAT(key, value)))        \
+  /**/
+
+#endif
@@ -10,20 +10,248 @@
 
 #include <hpx/include/actions.hpp>
 #include <hpx/include/components.hpp>
+#include <hpx/lcos/local/mutex.hpp>
+#include <hpx/lcos/local/promise.hpp>
+#include <hpx/lcos/local/shared_mutex.hpp>
+#include <hpx/lcos/local/spinlock.hpp>
+#include <hpx/runtime/serialization/serialize.hpp>
+#include <hpx/runtime/serialization/vector.hpp>
+#include <hpx/throw_exception.hpp>
+#include <hpx/runtime/serialization/serialize_buffer.hpp>
+#include <hpx/util/assert.hpp>
 #include <hpx/util/detail/pp/cat.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+// Operations which can be applied by the locality owning the data, see
+// dist_object::accumulate, fetch_and_op and their element-wise variants
+namespace dist_object {
+enum class op_type {
+  replace,
+  plus,
+  multiplies,
+  min,
+  max,
+  bit_and,
+  bit_or,
+  bit_xor
+};
+} // namespace dist_object
+
+// Concurrency policies of the dist_object servers, selecting how actions
+// running concurrently on the same partition are synchronized
+namespace dist_object {
+// Actions only reading the data (fetch and friends) run concurrently, actions
+// modifying it are exclusive. This is the default.
+struct shared_read_policy {
+  typedef hpx::lcos::local::shared_mutex mutex_type;
+  typedef std::shared_lock<mutex_type> read_lock;
+  typedef std::unique_lock<mutex_type> write_lock;
+};
+
+// Every action is exclusive, as with hpx::components::locking_hook
+struct exclusive_policy {
+  typedef hpx::lcos::local::mutex mutex_type;
+  typedef std::unique_lock<mutex_type> read_lock;
+  typedef std::unique_lock<mutex_type> write_lock;
+};
+
+// No synchronization at all, for callers ordering reads and writes by other
+// means (e.g. barriers)
+struct unsynchronized_policy {
+  struct mutex_type {};
+  struct read_lock {
+    explicit read_lock(mutex_type &) {}
+  };
+  typedef read_lock write_lock;
+};
+} // namespace dist_object
+
+namespace dist_object {
+namespace server {
+namespace detail {
+template <typename T> struct always_void { typedef void type; };
+
+struct no_element {};
+
+// Element type of a container partition, no_element for anything else.
+// Keeps the declarations of the container-only actions well-formed for
+// scalar types.
+template <typename T, typename Enable = void> struct element_type {
+  typedef no_element type;
+};
+
+template <typename T>
+struct element_type<T, typename always_void<typename T::value_type>::type> {
+  typedef typename std::remove_const<typename T::value_type>::type type;
+};
+
+// Allocator handing out a single chunk of memory provided by the caller.
+// Its address travels with the allocator when being serialized, which
+// allows a serialize_buffer to be deserialized straight into memory the
+// requesting locality already owns.
+template <typename T> class pointer_allocator {
+public:
+  typedef T value_type;
+  typedef T *pointer;
+  typedef T const *const_pointer;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <typename U> struct rebind { typedef pointer_allocator<U> other; };
+
+  pointer_allocator() noexcept : pointer_(nullptr), size_(0) {}
+
+  pointer_allocator(pointer p, size_type size) noexcept
+      : pointer_(p), size_(size) {}
+
+  pointer allocate(size_type n, void const * = nullptr) {
+    HPX_ASSERT(n == size_);
+    return pointer_;
+  }
+
+  void deallocate(pointer p, size_type n) {
+    HPX_ASSERT(p == pointer_ && n == size_);
+  }
+
+private:
+  friend class hpx::serialization::access;
+
+  template <typename Archive> void load(Archive &ar, unsigned int const) {
+    std::size_t address = 0;
+    ar >> size_ >> address;
+    pointer_ = reinterpret_cast<pointer>(address);
+  }
+
+  template <typename Archive> void save(Archive &ar, unsigned int const) const {
+    std::size_t address = reinterpret_cast<std::size_t>(pointer_);
+    ar << size_ << address;
+  }
+
+  HPX_SERIALIZATION_SPLIT_MEMBER()
+
+  pointer pointer_;
+  size_type size_;
+};
+
+template <typename T>
+T apply_bitwise_op(op_type op, T const &lhs, T const &rhs, std::true_type) {
+  switch (op) {
+  case op_type::bit_and:
+    return lhs & rhs;
+  case op_type::bit_or:
+    return lhs | rhs;
+  default:
+    return lhs ^ rhs;
+  }
+}
+
+template <typename T>
+T apply_bitwise_op(op_type, T const &lhs, T const &, std::false_type) {
+  HPX_THROW_EXCEPTION(hpx::bad_parameter, "dist_object::apply_op",
+                      "bitwise operations require an integral type");
+  return lhs;
+}
+
+// Combines lhs with rhs in place, according to op
+template <typename T> void apply_op(op_type op, T &lhs, T const &rhs) {
+  switch (op) {
+  case op_type::replace:
+    lhs = rhs;
+    break;
+  case op_type::plus:
+    lhs = lhs + rhs;
+    break;
+  case op_type::multiplies:
+    lhs = lhs * rhs;
+    break;
+  case op_type::min:
+    lhs = (std::min)(lhs, rhs);
+    break;
+  case op_type::max:
+    lhs = (std::max)(lhs, rhs);
+    break;
+  default:
+    lhs = apply_bitwise_op(op, lhs, rhs, std::is_integral<T>());
+    break;
+  }
+}
+
+// Matches values deposited by other localities with the local receive of the
+// same tag, in whichever order the two arrive. Used by the collectives, where
+// the tag identifies the operation and its step.
+template <typename Value> class mailbox {
+  struct slot {
+    slot() : matched(false) {}
+
+    hpx::lcos::local::promise<Value> promise;
+    bool matched;
+  };
+
+public:
+  hpx::future<Value> receive(std::uint64_t tag) {
+    std::lock_guard<hpx::lcos::local::spinlock> l(mtx_);
+    slot &s = slots_[tag];
+    hpx::future<Value> f = s.promise.get_future();
+    if (s.matched)
+      slots_.erase(tag);
+    else
+      s.matched = true;
+    return f;
+  }
+
+  void deposit(std::uint64_t tag, Value value) {
+    hpx::lcos::local::promise<Value> p;
+    {
+      std::lock_guard<hpx::lcos::local::spinlock> l(mtx_);
+      slot &s = slots_[tag];
+      if (!s.matched) {
+        // nobody is waiting yet, no continuation can run under the lock
+        s.matched = true;
+        s.promise.set_value(std::move(value));
+        return;
+      }
+      p = std::move(s.promise);
+      slots_.erase(tag);
+    }
+    p.set_value(std::move(value));
+  }
+
+private:
+  hpx::lcos::local::spinlock mtx_;
+  std::unordered_map<std::uint64_t, slot> slots_;
+};
+} // namespace detail
+} // namespace server
+} // namespace dist_object
+
 // Dist_object server maintains the local data for a given instance of
 // dist_object, and responds to non-local requests for its data
 namespace dist_object {
 namespace server {
-template <typename T>
+template <typename T, typename Policy = shared_read_policy>
 class dist_object_part
-    : public hpx::components::locking_hook<
-          hpx::components::component_base<dist_object_part<T>>> {
+    : public hpx::components::component_base<dist_object_part<T, Policy>> {
+  typedef typename Policy::read_lock read_lock;
+  typedef typename Policy::write_lock write_lock;
+
 public:
   typedef T data_type;
+  typedef typename detail::element_type<T>::type element_type;
+  typedef hpx::serialization::serialize_buffer<element_type> buffer_type;
+  typedef hpx::serialization::serialize_buffer<
+      element_type, detail::pointer_allocator<element_type>>
+      pointer_buffer_type;
+
   dist_object_part() {}
 
   dist_object_part(data_type const &data) : data_(data) {}
@@ -38,18 +266,179 @@ public:
 
   data_type *operator->() { return &data_; }
 
-  data_type fetch() const { return data_; }
+  data_type fetch() const {
+    read_lock l(mtx_);
+    return data_;
+  }
+
+  // Returns only the elements [offset, offset + count) of the local data.
+  // Only usable if data_type is a sequence container, the corresponding
+  // action is registered using REGISTER_DIST_OBJECT_PART_RANGE(type)
+  data_type fetch_range(std::size_t offset, std::size_t count) const {
+    read_lock l(mtx_);
+    HPX_ASSERT(offset + count <= data_.size());
+    auto first = std::next(std::begin(data_), offset);
+    return data_type(first, std::next(first, count));
+  }
+
+  // Zero-copy variant of fetch_range for contiguous containers of trivially
+  // copyable elements. The returned buffer references the local data, which
+  // is serialized straight out of the partition's storage after the action
+  // has returned. Callers have to make sure the range is not modified while
+  // the fetch is in flight. The action is registered using
+  // REGISTER_DIST_OBJECT_PART_BUFFER(type)
+  buffer_type fetch_buffer(std::size_t offset, std::size_t count) const {
+    static_assert(std::is_trivially_copyable<element_type>::value,
+                  "fetch_buffer requires trivially copyable elements");
+    HPX_ASSERT(offset + count <= data_.size());
+    return buffer_type(const_cast<element_type *>(data_.data()) + offset,
+                       count, buffer_type::reference);
+  }
+
+  // Backs dist_object::fetch_into: dest is the address of the caller's
+  // destination memory, the returned buffer is deserialized directly into it
+  pointer_buffer_type fetch_pointer(std::size_t offset, std::size_t count,
+                                    std::size_t dest) const {
+    static_assert(std::is_trivially_copyable<element_type>::value,
+                  "fetch_into requires trivially copyable elements");
+    HPX_ASSERT(offset + count <= data_.size());
+    detail::pointer_allocator<element_type> alloc(
+        reinterpret_cast<element_type *>(dest), count);
+    return pointer_buffer_type(const_cast<element_type *>(data_.data()) +
+                                   offset,
+                               count, pointer_buffer_type::reference, alloc);
+  }
+
+  // Overwrites the local data, registered using REGISTER_DIST_OBJECT_PART_PUT
+  void put(data_type const &value) {
+    write_lock l(mtx_);
+    data_ = value;
+  }
+
+  // Overwrites the elements [offset, offset + values.size()) of a sequence
+  // container, registered using REGISTER_DIST_OBJECT_PART_RANGE
+  void put_range(std::size_t offset, data_type const &values) {
+    write_lock l(mtx_);
+    HPX_ASSERT(offset + values.size() <= data_.size());
+    std::copy(std::begin(values), std::end(values),
+              std::next(std::begin(data_), offset));
+  }
+
+  // Zero-copy variant of put_range for contiguous containers of trivially
+  // copyable elements, registered using REGISTER_DIST_OBJECT_PART_BUFFER
+  void put_buffer(std::size_t offset, buffer_type const &values) {
+    write_lock l(mtx_);
+    HPX_ASSERT(offset + values.size() <= data_.size());
+    std::copy(values.data(), values.data() + values.size(),
+              data_.data() + offset);
+  }
+
+  // Remote read-modify-write operations on scalar data, registered using
+  // REGISTER_DIST_OBJECT_PART_ATOMIC(type). They run on the owning locality
+  // and are atomic with respect to all other actions on this partition,
+  // unless the unsynchronized_policy is used.
+  void accumulate(data_type const &value, op_type op) {
+    write_lock l(mtx_);
+    detail::apply_op(op, data_, value);
+  }
+
+  data_type fetch_and_op(data_type const &value, op_type op) {
+    write_lock l(mtx_);
+    data_type old = data_;
+    detail::apply_op(op, data_, value);
+    return old;
+  }
+
+  // Replaces the data with desired if it equals expected, returns the
+  // previous value in any case
+  data_type compare_exchange(data_type const &expected,
+                             data_type const &desired) {
+    write_lock l(mtx_);
+    data_type old = data_;
+    if (data_ == expected)
+      data_ = desired;
+    return old;
+  }
+
+  // Element-wise variants for containers of arithmetic elements, registered
+  // using REGISTER_DIST_OBJECT_PART_ELEMENT_ATOMIC(type)
+  void accumulate_range(std::size_t offset, buffer_type const &values,
+                        op_type op) {
+    write_lock l(mtx_);
+    HPX_ASSERT(offset + values.size() <= data_.size());
+    for (std::size_t i = 0; i != values.size(); ++i)
+      detail::apply_op(op, data_[offset + i], values[i]);
+  }
+
+  void accumulate_at(std::vector<std::size_t> const &indices,
+                     std::vector<element_type> const &values, op_type op) {
+    write_lock l(mtx_);
+    HPX_ASSERT(indices.size() == values.size());
+    for (std::size_t i = 0; i != indices.size(); ++i) {
+      HPX_ASSERT(indices[i] < data_.size());
+      detail::apply_op(op, data_[indices[i]], values[i]);
+    }
+  }
+
+  element_type fetch_and_op_at(std::size_t index, element_type const &value,
+                               op_type op) {
+    write_lock l(mtx_);
+    HPX_ASSERT(index < data_.size());
+    element_type old = data_[index];
+    detail::apply_op(op, data_[index], value);
+    return old;
+  }
+
+  element_type compare_exchange_at(std::size_t index,
+                                   element_type const &expected,
+                                   element_type const &desired) {
+    write_lock l(mtx_);
+    HPX_ASSERT(index < data_.size());
+    element_type old = data_[index];
+    if (old == expected)
+      data_[index] = desired;
+    return old;
+  }
+
+  // Point-to-point transfer used by the collectives of the dist_object,
+  // registered using REGISTER_DIST_OBJECT_PART_COLLECTIVES(type). The value
+  // sent by deposit is handed to the local receive of the same tag and does
+  // not touch the data of this partition.
+  void deposit(std::uint64_t tag, data_type const &value) {
+    mailbox_.deposit(tag, value);
+  }
+
+  hpx::future<data_type> receive(std::uint64_t tag) {
+    return mailbox_.receive(tag);
+  }
 
   HPX_DEFINE_COMPONENT_ACTION(dist_object_part, fetch);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, fetch_range);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, fetch_buffer);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, fetch_pointer);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, put);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, put_range);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, put_buffer);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, accumulate);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, fetch_and_op);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, compare_exchange);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, accumulate_range);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, accumulate_at);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, fetch_and_op_at);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, compare_exchange_at);
+  HPX_DEFINE_COMPONENT_ACTION(dist_object_part, deposit);
 
 private:
+  mutable typename Policy::mutex_type mtx_;
   data_type data_;
+  detail::mailbox<data_type> mailbox_;
 };
 
-template <typename T>
-class dist_object_part<T &>
-    : public hpx::components::locking_hook<
-          hpx::components::component_base<dist_object_part<T &>>> {
+template <typename T, typename Policy>
+class dist_object_part<T &, Policy>
+    : public hpx::components::component_base<dist_object_part<T &, Policy>> {
+  typedef typename Policy::read_lock read_lock;
+
 public:
   typedef T &data_type;
   dist_object_part() {}
@@ -66,30 +455,288 @@ public:
 
   T *operator->() { return data_; }
 
-  T fetch() const { return data_; }
+  T fetch() const {
+    read_lock l(mtx_);
+    return data_;
+  }
 
   HPX_DEFINE_COMPONENT_ACTION(dist_object_part, fetch);
 
 private:
+  mutable typename Policy::mutex_type mtx_;
   data_type data_;
 };
 } // namespace server
 } // namespace dist_object
 
+// All registration macros come in two flavors: the plain one registers the
+// partition with the default shared_read_policy, the _WITH_POLICY one with
+// the given policy (e.g. unsynchronized_policy). Each combination of type
+// and policy in use has to be registered.
+#define DIST_OBJECT_PART_TYPE(type, policy)                                   \
+  HPX_PP_CAT(__dist_object_part_type_, HPX_PP_CAT(type, policy))
+/**/
+
+#define DIST_OBJECT_PART_TYPEDEF(type, policy)                                \
+  typedef dist_object::server::dist_object_part<type, dist_object::policy>    \
+      DIST_OBJECT_PART_TYPE(type, policy);
+/**/
+
 #define REGISTER_DIST_OBJECT_PART_DECLARATION(type)                           \
+  REGISTER_DIST_OBJECT_PART_WITH_POLICY_DECLARATION(type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_WITH_POLICY_DECLARATION(type, policy)       \
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
   HPX_REGISTER_ACTION_DECLARATION(                                            \
-      dist_object::server::dist_object_part<type>::fetch_action,              \
-      HPX_PP_CAT(__dist_object_part_fetch_action_, type));
+      DIST_OBJECT_PART_TYPE(type, policy)::fetch_action,                      \
+      HPX_PP_CAT(__dist_object_part_fetch_action_,                            \
+                 HPX_PP_CAT(type, policy)));                                  \
+  /**/
 
+#define REGISTER_DIST_OBJECT_PART(type)                                       \
+  REGISTER_DIST_OBJECT_PART_WITH_POLICY(type, shared_read_policy)
 /**/
 
-#define REGISTER_DIST_OBJECT_PART(type)                                       \
+#define REGISTER_DIST_OBJECT_PART_WITH_POLICY(type, policy)                   \
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
   HPX_REGISTER_ACTION(                                                        \
-      dist_object::server::dist_object_part<type>::fetch_action,              \
-      HPX_PP_CAT(__dist_object_part_fetch_action_, type));                    \
+      DIST_OBJECT_PART_TYPE(type, policy)::fetch_action,                      \
+      HPX_PP_CAT(__dist_object_part_fetch_action_,                            \
+                 HPX_PP_CAT(type, policy)));                                  \
   typedef ::hpx::components::component<                                       \
-      dist_object::server::dist_object_part<type>>                            \
-      HPX_PP_CAT(__dist_object_part_, type);                                  \
-  HPX_REGISTER_COMPONENT(HPX_PP_CAT(__dist_object_part_, type))               \
+      DIST_OBJECT_PART_TYPE(type, policy)>                                    \
+      HPX_PP_CAT(__dist_object_part_, HPX_PP_CAT(type, policy));              \
+  HPX_REGISTER_COMPONENT(                                                     \
+      HPX_PP_CAT(__dist_object_part_, HPX_PP_CAT(type, policy)))              \
+  /**/
+
+// Non-const types can additionally be written remotely, after registering
+// the put action using these macros
+#define REGISTER_DIST_OBJECT_PART_PUT_DECLARATION(type)                       \
+  REGISTER_DIST_OBJECT_PART_PUT_WITH_POLICY_DECLARATION(                      \
+      type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_PUT_WITH_POLICY_DECLARATION(type, policy)   \
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::put_action,                        \
+      HPX_PP_CAT(__dist_object_part_put_action_,                              \
+                 HPX_PP_CAT(type, policy)));                                  \
+  /**/
+
+#define REGISTER_DIST_OBJECT_PART_PUT(type)                                   \
+  REGISTER_DIST_OBJECT_PART_PUT_WITH_POLICY(type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_PUT_WITH_POLICY(type, policy)               \
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::put_action,                        \
+      HPX_PP_CAT(__dist_object_part_put_action_,                              \
+                 HPX_PP_CAT(type, policy)));                                  \
+  /**/
+
+// Non-const sequence container types (e.g. std::vector<int>) additionally
+// register the ranged fetch and put actions using these macros
+#define REGISTER_DIST_OBJECT_PART_RANGE_DECLARATION(type)                     \
+  REGISTER_DIST_OBJECT_PART_RANGE_WITH_POLICY_DECLARATION(                    \
+      type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_RANGE_WITH_POLICY_DECLARATION(type, policy) \
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::fetch_range_action,                \
+      HPX_PP_CAT(__dist_object_part_fetch_range_action_,                      \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::put_range_action,                  \
+      HPX_PP_CAT(__dist_object_part_put_range_action_,                        \
+                 HPX_PP_CAT(type, policy)));                                  \
+  /**/
+
+#define REGISTER_DIST_OBJECT_PART_RANGE(type)                                 \
+  REGISTER_DIST_OBJECT_PART_RANGE_WITH_POLICY(type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_RANGE_WITH_POLICY(type, policy)             \
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::fetch_range_action,                \
+      HPX_PP_CAT(__dist_object_part_fetch_range_action_,                      \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::put_range_action,                  \
+      HPX_PP_CAT(__dist_object_part_put_range_action_,                        \
+                 HPX_PP_CAT(type, policy)));                                  \
+  /**/
+
+// Non-const contiguous containers of trivially copyable elements (e.g.
+// std::vector<double>) additionally register the zero-copy actions
+#define REGISTER_DIST_OBJECT_PART_BUFFER_DECLARATION(type)                    \
+  REGISTER_DIST_OBJECT_PART_BUFFER_WITH_POLICY_DECLARATION(                   \
+      type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_BUFFER_WITH_POLICY_DECLARATION(type, policy)\
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::fetch_buffer_action,               \
+      HPX_PP_CAT(__dist_object_part_fetch_buffer_action_,                     \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::fetch_pointer_action,              \
+      HPX_PP_CAT(__dist_object_part_fetch_pointer_action_,                    \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::put_buffer_action,                 \
+      HPX_PP_CAT(__dist_object_part_put_buffer_action_,                       \
+                 HPX_PP_CAT(type, policy)));                                  \
+  /**/
+
+#define REGISTER_DIST_OBJECT_PART_BUFFER(type)                                \
+  REGISTER_DIST_OBJECT_PART_BUFFER_WITH_POLICY(type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_BUFFER_WITH_POLICY(type, policy)            \
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::fetch_buffer_action,               \
+      HPX_PP_CAT(__dist_object_part_fetch_buffer_action_,                     \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::fetch_pointer_action,              \
+      HPX_PP_CAT(__dist_object_part_fetch_pointer_action_,                    \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::put_buffer_action,                 \
+      HPX_PP_CAT(__dist_object_part_put_buffer_action_,                       \
+                 HPX_PP_CAT(type, policy)));                                  \
+  /**/
+
+// Arithmetic types (e.g. int) additionally register the remote
+// read-modify-write actions using these macros
+#define REGISTER_DIST_OBJECT_PART_ATOMIC_DECLARATION(type)                    \
+  REGISTER_DIST_OBJECT_PART_ATOMIC_WITH_POLICY_DECLARATION(                   \
+      type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_ATOMIC_WITH_POLICY_DECLARATION(type, policy)\
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::accumulate_action,                 \
+      HPX_PP_CAT(__dist_object_part_accumulate_action_,                       \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::fetch_and_op_action,               \
+      HPX_PP_CAT(__dist_object_part_fetch_and_op_action_,                     \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::compare_exchange_action,           \
+      HPX_PP_CAT(__dist_object_part_compare_exchange_action_,                 \
+                 HPX_PP_CAT(type, policy)));                                  \
+  /**/
+
+#define REGISTER_DIST_OBJECT_PART_ATOMIC(type)                                \
+  REGISTER_DIST_OBJECT_PART_ATOMIC_WITH_POLICY(type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_ATOMIC_WITH_POLICY(type, policy)            \
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::accumulate_action,                 \
+      HPX_PP_CAT(__dist_object_part_accumulate_action_,                       \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::fetch_and_op_action,               \
+      HPX_PP_CAT(__dist_object_part_fetch_and_op_action_,                     \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::compare_exchange_action,           \
+      HPX_PP_CAT(__dist_object_part_compare_exchange_action_,                 \
+                 HPX_PP_CAT(type, policy)));                                  \
+  /**/
+
+// Non-const contiguous containers of arithmetic elements (e.g.
+// std::vector<int>) additionally register the element-wise read-modify-write
+// actions using these macros
+#define REGISTER_DIST_OBJECT_PART_ELEMENT_ATOMIC_DECLARATION(type)            \
+  REGISTER_DIST_OBJECT_PART_ELEMENT_ATOMIC_WITH_POLICY_DECLARATION(           \
+      type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_ELEMENT_ATOMIC_WITH_POLICY_DECLARATION(     \
+    type, policy)                                                             \
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::accumulate_range_action,           \
+      HPX_PP_CAT(__dist_object_part_accumulate_range_action_,                 \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::accumulate_at_action,              \
+      HPX_PP_CAT(__dist_object_part_accumulate_at_action_,                    \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::fetch_and_op_at_action,            \
+      HPX_PP_CAT(__dist_object_part_fetch_and_op_at_action_,                  \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::compare_exchange_at_action,        \
+      HPX_PP_CAT(__dist_object_part_compare_exchange_at_action_,              \
+                 HPX_PP_CAT(type, policy)));                                  \
+  /**/
+
+#define REGISTER_DIST_OBJECT_PART_ELEMENT_ATOMIC(type)                        \
+  REGISTER_DIST_OBJECT_PART_ELEMENT_ATOMIC_WITH_POLICY(type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_ELEMENT_ATOMIC_WITH_POLICY(type, policy)    \
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::accumulate_range_action,           \
+      HPX_PP_CAT(__dist_object_part_accumulate_range_action_,                 \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::accumulate_at_action,              \
+      HPX_PP_CAT(__dist_object_part_accumulate_at_action_,                    \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::fetch_and_op_at_action,            \
+      HPX_PP_CAT(__dist_object_part_fetch_and_op_at_action_,                  \
+                 HPX_PP_CAT(type, policy)));                                  \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::compare_exchange_at_action,        \
+      HPX_PP_CAT(__dist_object_part_compare_exchange_at_action_,              \
+                 HPX_PP_CAT(type, policy)));                                  \
+  /**/
+
+// Types taking part in the collectives (reduce, all_reduce, broadcast, ...)
+// of the dist_object additionally register the deposit action
+#define REGISTER_DIST_OBJECT_PART_COLLECTIVES_DECLARATION(type)               \
+  REGISTER_DIST_OBJECT_PART_COLLECTIVES_WITH_POLICY_DECLARATION(              \
+      type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_COLLECTIVES_WITH_POLICY_DECLARATION(        \
+    type, policy)                                                             \
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
+  HPX_REGISTER_ACTION_DECLARATION(                                            \
+      DIST_OBJECT_PART_TYPE(type, policy)::deposit_action,                    \
+      HPX_PP_CAT(__dist_object_part_deposit_action_,                          \
+                 HPX_PP_CAT(type, policy)));                                  \
+  /**/
+
+#define REGISTER_DIST_OBJECT_PART_COLLECTIVES(type)                           \
+  REGISTER_DIST_OBJECT_PART_COLLECTIVES_WITH_POLICY(type, shared_read_policy)
+/**/
+
+#define REGISTER_DIST_OBJECT_PART_COLLECTIVES_WITH_POLICY(type, policy)       \
+  DIST_OBJECT_PART_TYPEDEF(type, policy)                                      \
+  HPX_REGISTER_ACTION(                                                        \
+      DIST_OBJECT_PART_TYPE(type, policy)::deposit_action,                    \
+      HPX_PP_CAT(__dist_object_part_deposit_action_,                          \
+                 HPX_PP_CAT(type, policy)));                                  \
   /**/
 #endif
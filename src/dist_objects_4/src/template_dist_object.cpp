@@ -9,16 +9,71 @@
 #include <hpx/hpx.hpp>
 #include <hpx/runtime/components/component_factory.hpp>
 
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 ///////////////////////////////////////////////////////////////////////////////
 // Add factory registration functionality.
 
 HPX_REGISTER_COMPONENT_MODULE();
 
-typedef hpx::components::component<dist_object::meta_object_server>
-    meta_object_type;
+HPX_REGISTER_ACTION(meta_registration_action, meta_registration_action);
+
+typedef hpx::components::component<dist_object::tree_registration_server>
+    tree_registration_type;
+
+HPX_REGISTER_COMPONENT(tree_registration_type, tree_registration);
+
+HPX_REGISTER_ACTION(tree_registration_type::collect_action,
+                    tree_collect_tr_action);
+
+///////////////////////////////////////////////////////////////////////////////
+namespace dist_object { namespace detail {
+    namespace {
+        // The meta_object_servers of the Meta_Object registrations which are
+        // in progress on this (root) locality, keyed by basename
+        struct meta_registry
+        {
+            hpx::lcos::local::spinlock mtx;
+            std::unordered_map<std::string,
+                std::shared_ptr<meta_object_server>> servers;
+        };
+
+        meta_registry& get_meta_registry()
+        {
+            static meta_registry registry;
+            return registry;
+        }
+    }
+
+    hpx::future<std::unordered_map<std::size_t, hpx::id_type>>
+        meta_registration(std::string basename, std::size_t num_locs,
+            std::size_t source_loc, hpx::id_type id)
+    {
+        meta_registry& registry = get_meta_registry();
+
+        // the last registration retires the server under the same lock
+        // which found it, so a registration under the same basename which
+        // arrives later always starts a new one
+        std::shared_ptr<meta_object_server> server;
+        bool last = false;
+        {
+            std::lock_guard<hpx::lcos::local::spinlock> l(registry.mtx);
+            std::shared_ptr<meta_object_server>& p =
+                registry.servers[basename];
+            if (!p)
+                p = std::make_shared<meta_object_server>(num_locs);
+            server = p;
 
-HPX_REGISTER_COMPONENT(meta_object_type, meta_object);
+            last = server->registration(source_loc, std::move(id));
+            if (last)
+                registry.servers.erase(basename);
+        }
 
-HPX_REGISTER_ACTION(meta_object_type::registration_action, register_mo_action);
-HPX_REGISTER_ACTION(meta_object_type::get_server_list_action,
-                    get_server_list_mo_action);
+        if (last)
+            server->publish();
+        return server->result();
+    }
+}}
@@ -11,21 +11,35 @@
 #include "server/template_dist_object.hpp"
 
 #include <hpx/include/actions.hpp>
+#include <hpx/include/apply.hpp>
 #include <hpx/include/components.hpp>
 #include <hpx/include/lcos.hpp>
 #include <hpx/include/parallel_for_each.hpp>
+#include <hpx/include/parallel_scan.hpp>
+#include <hpx/include/parallel_transform.hpp>
 #include <hpx/lcos/barrier.hpp>
+#include <hpx/lcos/local/promise.hpp>
+#include <hpx/runtime/config_entry.hpp>
 #include <hpx/runtime/serialization/unordered_map.hpp>
 #include <hpx/util/assert.hpp>
 #include <hpx/util/bind.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <numeric>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 
 
@@ -33,121 +47,408 @@
 // is going to be used. That is, whether each dist_object will register with
 // each other dist_object through AGAS directly, or whether it will wait for
 // each dist_object to register with a central meta_object running on the 
-// root locality
+// root locality, or whether the ids are gathered and broadcast along a k-ary
+// tree of the participating localities
 namespace dist_object {
-	enum class construction_type{ Meta_Object, All_to_All };
+	enum class construction_type{ Meta_Object, All_to_All, Tree };
 }
 
-// The meta_object_server handles the data for the meta_object, and also
-// is where the registration code is declared and run.
+// The meta_object_server collects the ids registered for one Meta_Object
+// dist_object. It only ever exists on the root locality, where it is
+// created on demand by the first registration request for its basename.
 namespace dist_object {
-	class meta_object_server : public hpx::components::locking_hook<
-		hpx::components::component_base<meta_object_server>> {
+	class meta_object_server {
 	public:
+		typedef std::unordered_map<std::size_t, hpx::id_type> table_type;
 
+		explicit meta_object_server(std::size_t num_locs)
+			: num_locs_(num_locs), result_(promise_.get_future())
+		{
+		}
+
+		// Records the id, returns whether this was the last locality to
+		// register. The caller then has to call publish
+		bool registration(std::size_t source_loc, hpx::id_type id)
+		{
+			std::lock_guard<hpx::lcos::local::spinlock> l(lk);
+			HPX_ASSERT(servers_.size() < num_locs_);
+			servers_[source_loc] = id;
+			return servers_.size() == num_locs_;
+		}
 
-		meta_object_server(std::size_t num_locs, std::size_t root) : b(num_locs), root_(root)
-		{ 
-			servers_ = std::unordered_map<std::size_t, hpx::id_type>();
-			retrieved = false;
+		// Hands the ids of all localities to the waiting registrations
+		void publish()
+		{
+			promise_.set_value(servers_);
 		}
 
-		std::unordered_map<std::size_t, hpx::id_type> get_server_list() {
-			return servers_;
+		// Becomes ready with all ids once every locality registered
+		hpx::future<table_type> result() const
+		{
+			return result_.then(hpx::launch::sync,
+				[](hpx::shared_future<table_type> f)
+				{
+					return f.get();
+				});
 		}
 
-		//std::vector<hpx::id_type> get_server_list() {
-		//	return servers__;
-		//}
+	private:
+		hpx::lcos::local::spinlock lk;
+		std::size_t num_locs_;
+		table_type servers_;
+		hpx::lcos::local::promise<table_type> promise_;
+		hpx::shared_future<table_type> result_;
+	};
+
+	namespace detail {
+		// Executed on the root locality, forwards to the meta_object_server
+		// of the given basename, creating it if this is the first request
+		HPX_COMPONENT_EXPORT
+		hpx::future<std::unordered_map<std::size_t, hpx::id_type>>
+			meta_registration(std::string basename, std::size_t num_locs,
+				std::size_t source_loc, hpx::id_type id);
+	}
+}
+
+HPX_DEFINE_PLAIN_ACTION(dist_object::detail::meta_registration,
+	meta_registration_action);
+HPX_REGISTER_ACTION_DECLARATION(meta_registration_action,
+	meta_registration_action);
+
+// Meta_object front end. Registration is a single request to the root
+// locality, no component is created and no lookup is done on the others
+namespace dist_object {
+	class meta_object {
+	public:
+		typedef meta_object_server::table_type table_type;
+
+		meta_object(std::string basename, std::size_t num_locs,
+			std::size_t root)
+			: basename_(basename), num_locs_(num_locs), root_(root)
+		{
+		}
 
-		std::unordered_map<std::size_t, hpx::id_type> registration(std::size_t source_loc, hpx::id_type id) 
+		hpx::future<table_type> registration(hpx::id_type id)
 		{
+			return hpx::async<meta_registration_action>(
+				hpx::naming::get_id_from_locality_id(
+					static_cast<std::uint32_t>(root_)),
+				basename_, num_locs_, std::size_t(hpx::get_locality_id()),
+				id);
+		}
+
+	private:
+		std::string basename_;
+		std::size_t num_locs_;
+		std::size_t root_;
+	};
+}
+
+// The tree_registration_server is one node of the k-ary tree used by the
+// Tree construction type. Each node merges the id tables of its children
+// with its own and forwards the result to its parent. The complete table
+// then travels back down as the return value of those calls.
+namespace dist_object {
+	class tree_registration_server
+		: public hpx::components::component_base<tree_registration_server> {
+	public:
+		typedef std::unordered_map<std::size_t, hpx::id_type> table_type;
+
+		tree_registration_server(std::size_t expected, hpx::id_type parent)
+			: expected_(expected), arrived_(0), parent_(parent),
+			  result_future_(result_.get_future())
+		{
+			HPX_ASSERT(expected_ > 0);
+		}
+
+		// Called once by the local locality and once by every child, each
+		// with the ids of its subtree. Returns the ids of the whole tree
+		hpx::future<table_type> collect(table_type table)
+		{
+			bool last = false;
 			{
 				std::lock_guard<hpx::lcos::local::spinlock> l(lk);
-				servers_[source_loc] = id;
+				table_.insert(table.begin(), table.end());
+				last = (++arrived_ == expected_);
+			}
+
+			if (last) {
+				if (parent_) {
+					hpx::async<collect_action>(parent_, std::move(table_))
+						.then(hpx::launch::sync,
+							[this](hpx::future<table_type> f)
+							{
+								try {
+									result_.set_value(f.get());
+								}
+								catch (...) {
+									result_.set_exception(
+										std::current_exception());
+								}
+							});
+				}
+				else {
+					result_.set_value(std::move(table_));
+				}
 			}
-			b.wait();
-			return servers_;
+
+			return result_future_.then(hpx::launch::sync,
+				[](hpx::shared_future<table_type> f)
+				{
+					return f.get();
+				});
 		}
 
-		//std::vector< hpx::id_type> registration(std::size_t source_loc, hpx::id_type id)
-		//{
-		//	{
-		//		std::lock_guard<hpx::lcos::local::spinlock> l(lk);
-		//		servers__[source_loc] = id;
-		//	}
-		//	b.wait();
-		//	return servers__;
-		//}
+		HPX_DEFINE_COMPONENT_ACTION(tree_registration_server, collect);
 
-		HPX_DEFINE_COMPONENT_ACTION(meta_object_server, get_server_list);
-		HPX_DEFINE_COMPONENT_ACTION(meta_object_server, registration);
-			   
 	private:
-		hpx::lcos::local::barrier b;
 		hpx::lcos::local::spinlock lk;
-		bool retrieved;
-		std::size_t root_;
-		std::unordered_map<std::size_t, hpx::id_type> servers_;
-		std::vector<hpx::id_type> servers__;
+		std::size_t expected_;
+		std::size_t arrived_;
+		hpx::id_type parent_;
+		table_type table_;
+		hpx::lcos::local::promise<table_type> result_;
+		hpx::shared_future<table_type> result_future_;
 	};
 }
 
-typedef dist_object::meta_object_server::get_server_list_action get_list_action;
-HPX_REGISTER_ACTION_DECLARATION(get_list_action, get_server_list_mo_action);
-typedef dist_object::meta_object_server::registration_action register_with_meta_action;
-HPX_REGISTER_ACTION_DECLARATION(register_with_meta_action, register_mo_action);
+typedef dist_object::tree_registration_server::collect_action
+	tree_collect_action;
+HPX_REGISTER_ACTION_DECLARATION(tree_collect_action, tree_collect_tr_action);
 
-// Meta_object front end, decides whether it is the root locality, and thus
-// whether to register with the root locality's meta object only or to register
-// itself as the root locality's meta object as well
+// Tree registration front end. Places the calling locality in a k-ary tree
+// spanning the participating localities, where the arity is taken from the
+// configuration entry dist_object.tree_arity (default 8). Every node only
+// talks to its parent and its children, which keeps the work per locality
+// at O(k) and the latency at O(log N)
 namespace dist_object {
-	class meta_object : hpx::components::client_base<meta_object, meta_object_server> {
+	class tree_registration
+		: hpx::components::client_base<tree_registration,
+			tree_registration_server> {
 	public:
-		typedef hpx::components::client_base<meta_object, meta_object_server> base_type;
-		
-		meta_object(std::string basename, std::size_t num_locs, std::size_t root) : 
-			base_type(hpx::new_<meta_object_server>(hpx::find_here(), num_locs, root))
+		typedef hpx::components::client_base<tree_registration,
+			tree_registration_server> base_type;
+		typedef tree_registration_server::table_type table_type;
+
+		// localities has to be sorted and contain the calling locality
+		tree_registration(std::string basename,
+			std::vector<std::size_t> const& localities)
+			: base_type(create_server(basename + "/tree", localities)),
+			  basename_(basename + "/tree")
 		{
-			if (hpx::get_locality_id() == root) {
-				hpx::register_with_basename(basename, get_id(),hpx::get_locality_id());
-			}
-			meta_object_0 = hpx::find_from_basename(basename, root).get();
+			// the server may still wait for the parent, registering it must
+			// not block
+			hpx::register_with_basename(basename_,
+				static_cast<base_type&>(*this), hpx::get_locality_id());
 		}
 
-		std::unordered_map<std::size_t, hpx::id_type> get_server_list() {
+		// Contributes the id of the local partition, the returned future
+		// holds the ids of all partitions once every locality contributed
+		hpx::future<table_type> registration(hpx::id_type id)
+		{
+			table_type table;
+			table[hpx::get_locality_id()] = id;
+
+			// the continuation keeps this node alive until it is done
+			tree_registration self(*this);
+			return this->share().then(hpx::launch::sync,
+				[table](hpx::shared_future<hpx::id_type> f)
+				{
+					return hpx::async(tree_collect_action(), f.get(), table);
+				}).then(hpx::launch::sync,
+				[self](hpx::future<table_type> f)
+				{
+					table_type result = f.get();
+
+					// all children found this node already, the name can be
+					// reused
+					hpx::unregister_with_basename(self.basename_,
+						hpx::get_locality_id());
+					return result;
+				});
+		}
+
+	private:
+		static hpx::future<hpx::id_type> create_server(
+			std::string const& basename,
+			std::vector<std::size_t> const& localities)
+		{
+			std::size_t const here = hpx::get_locality_id();
+			std::size_t const num_nodes = localities.size();
+			std::size_t const rank = std::distance(localities.begin(),
+				std::lower_bound(localities.begin(), localities.end(), here));
+			HPX_ASSERT(rank < num_nodes && localities[rank] == here);
+
+			std::size_t arity = std::stoul(
+				hpx::get_config_entry("dist_object.tree_arity", "8"));
+			if (arity < 2)
+				arity = 2;
+
+			// children of rank r are r * k + 1 ... r * k + k
+			std::size_t first_child = rank * arity + 1;
+			std::size_t num_children = 0;
+			if (first_child < num_nodes)
+				num_children = (std::min)(arity, num_nodes - first_child);
+
+			if (rank == 0) {
+				return hpx::local_new<tree_registration_server>(
+					num_children + 1, hpx::id_type());
+			}
 
-			return hpx::async(get_list_action(), meta_object_0).get();
+			// the node is created once its parent is known, without
+			// suspending the caller until then
+			return hpx::find_from_basename(basename,
+				localities[(rank - 1) / arity]).then(hpx::launch::sync,
+				[num_children](hpx::future<hpx::id_type> f)
+				{
+					return hpx::local_new<tree_registration_server>(
+						num_children + 1, f.get());
+				});
 		}
 
+	private:
+		std::string basename_;
+	};
+}
 
-		//hpx::future<std::vector<hpx::id_type>> get_server_list() {
+// The id_cache holds the ids of the partitions of a dist_object. It is shared
+// by all copies of a dist_object client
+namespace dist_object {
+	namespace detail {
+		// Fixed-size, lock-free table of (future) ids indexed by locality. The
+		// first lookup of an index installs its entry with a single
+		// compare-and-swap, so concurrent lookups of the same index share one
+		// AGAS query and nobody blocks while it is in flight.
+		class id_cache : public std::enable_shared_from_this<id_cache> {
+			struct entry {
+				entry() : id(promise.get_future()) {}
+
+				explicit entry(hpx::id_type const& known)
+					: id(hpx::make_ready_future(known)) {}
+
+				hpx::lcos::local::promise<hpx::id_type> promise;
+				hpx::shared_future<hpx::id_type> id;
+			};
+
+		public:
+			explicit id_cache(std::size_t size)
+				: size_(size), entries_(new std::atomic<entry*>[size])
+			{
+				for (std::size_t i = 0; i != size_; ++i)
+					entries_[i].store(nullptr, std::memory_order_relaxed);
+			}
 
-		//	return hpx::async(get_list_action(), meta_object_0);
-		//}
+			~id_cache()
+			{
+				for (std::size_t i = 0; i != size_; ++i)
+					delete entries_[i].load(std::memory_order_relaxed);
+			}
 
-		std::unordered_map<std::size_t, hpx::id_type> registration(hpx::id_type id) 
-		{
-			hpx::future<std::unordered_map<std::size_t, hpx::id_type>> ret = hpx::async(register_with_meta_action(), meta_object_0, 
-				hpx::get_locality_id(), id);
-			std::unordered_map<std::size_t, hpx::id_type> ret_ = ret.get();
-			return ret_;
+			id_cache(id_cache const&) = delete;
+			id_cache& operator=(id_cache const&) = delete;
+
+			std::size_t size() const { return size_; }
+
+			// Returns the (future) id for the given index. lookup is invoked
+			// only by the first caller asking for that index and has to
+			// return a hpx::future<hpx::id_type>
+			template <typename Lookup>
+			hpx::shared_future<hpx::id_type> get(std::size_t idx,
+				Lookup&& lookup)
+			{
+				HPX_ASSERT(idx < size_);
+				entry* e = entries_[idx].load(std::memory_order_acquire);
+				if (e)
+					return e->id;
+
+				std::unique_ptr<entry> created(new entry);
+				if (!entries_[idx].compare_exchange_strong(e, created.get(),
+					std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					// somebody else's query for this index is in flight
+					return e->id;
+				}
+
+				e = created.release();
+				std::shared_ptr<id_cache> self = shared_from_this();
+				lookup().then(hpx::launch::sync,
+					[self, e](hpx::future<hpx::id_type> f)
+					{
+						try {
+							e->promise.set_value(f.get());
+						}
+						catch (...) {
+							e->promise.set_exception(std::current_exception());
+						}
+					});
+				return e->id;
+			}
+
+			// Seeds the table with an id which is already known
+			void set(std::size_t idx, hpx::id_type const& id)
+			{
+				HPX_ASSERT(idx < size_);
+				std::unique_ptr<entry> created(new entry(id));
+				entry* expected = nullptr;
+				if (entries_[idx].compare_exchange_strong(expected,
+					created.get(), std::memory_order_acq_rel))
+				{
+					created.release();
+				}
+			}
 
-		//std::vector<hpx::id_type> registration(hpx::id_type id) {
-		//	return hpx::async(register_with_meta_action(), meta_object_0, 
-		//		hpx::get_locality_id(), id).get();
+		private:
+			std::size_t size_;
+			std::unique_ptr<std::atomic<entry*>[]> entries_;
+		};
+	}
+}
 
+// Adapts a binary operation on elements (e.g. std::plus<int>) to containers
+// of equal size, to reduce vector partitions with the collectives of the
+// dist_object
+namespace dist_object {
+	template <typename Op>
+	struct element_wise_op {
+		template <typename Container>
+		Container operator()(Container lhs, Container const& rhs) const {
+			HPX_ASSERT(lhs.size() == rhs.size());
+			auto it = std::begin(rhs);
+			for (auto& e : lhs) {
+				e = op(e, *it);
+				++it;
+			}
+			return lhs;
 		}
 
-		//std::vector<hpx::id_type> registration(hpx::id_type id)
-		//{
-		//	return hpx::async(register_with_meta_action(), meta_object_0,
-		//		hpx::get_locality_id(), id).get();
-		//}
+		Op op;
+	};
 
-		
-	private:
-		hpx::id_type meta_object_0;
+	template <typename Op>
+	element_wise_op<typename std::decay<Op>::type> element_wise(Op&& op) {
+		return element_wise_op<typename std::decay<Op>::type>{
+			std::forward<Op>(op)};
+	}
+}
+
+// Result of the gathering collectives of the dist_object: the partitions of
+// all participating localities stored back to back. The partition of the
+// i-th locality is [offsets[i], offsets[i + 1]) of data.
+namespace dist_object {
+	template <typename T>
+	struct gathered {
+		std::vector<T> data;
+		std::vector<std::size_t> offsets;
+
+		std::size_t size() const {
+			return offsets.empty() ? 0 : offsets.size() - 1;
+		}
+
+		std::vector<T> slice(std::size_t i) const {
+			HPX_ASSERT(i + 1 < offsets.size());
+			return std::vector<T>(data.begin() + offsets[i],
+				data.begin() + offsets[i + 1]);
+		}
 	};
 }
 
@@ -155,18 +456,29 @@ namespace dist_object {
 // the server, and stores information locally about the localities/servers
 // that it needs to know about
 namespace dist_object {
-	template <typename T, construction_type C = construction_type::All_to_All>
+	template <typename T, construction_type C = construction_type::All_to_All,
+		typename Policy = shared_read_policy>
 	class dist_object
-		: hpx::components::client_base<dist_object<T>, server::dist_object_part<T>> {
-		typedef hpx::components::client_base<dist_object<T>, 
-			server::dist_object_part<T>> base_type;
+		: hpx::components::client_base<dist_object<T, C, Policy>,
+			server::dist_object_part<T, Policy>> {
+		typedef server::dist_object_part<T, Policy> server_type;
+		typedef hpx::components::client_base<dist_object<T, C, Policy>,
+			server_type> base_type;
 
-		typedef typename server::dist_object_part<T>::data_type data_type;
+		typedef typename server_type::data_type data_type;
+
+	public:
+		typedef typename server_type::element_type element_type;
+		typedef typename server_type::buffer_type buffer_type;
+
+	private:
+		typedef typename server_type::pointer_buffer_type
+			pointer_buffer_type;
 
 	private:
 		template <typename Arg>
 		static hpx::future<hpx::id_type> create_server(Arg &&value) {
-			return hpx::local_new<server::dist_object_part<T>>(
+			return hpx::local_new<server_type>(
 				std::forward<Arg>(value));
 		}
 
@@ -177,17 +489,24 @@ namespace dist_object {
 			: base_type(create_server(data)), base_(base) 
 		{
 			assert(C == construction_type::All_to_All ||
-				C == construction_type::Meta_Object);
+				C == construction_type::Meta_Object ||
+				C == construction_type::Tree);
 			assert(localities.size() > 0);
 			assert(std::find(localities.begin(), localities.end(), 
 				hpx::get_locality_id()) != localities.end());
 
 			std::sort(localities.begin(), localities.end());
-			
+			localities_ = localities;
+
 			if (C == construction_type::Meta_Object) {
 				meta_object mo(base, localities.size(), localities[0]);
-				locs =	mo.registration(get_id());			
 				basename_registration_helper(base);
+				seed_ids(mo.registration(get_id()).get());
+			}
+			else if (C == construction_type::Tree) {
+				tree_registration tr(base, localities_);
+				basename_registration_helper(base);
+				seed_ids(tr.registration(get_id()).get());
 			}
 			else {
 				basename_registration_helper(base);
@@ -198,15 +517,21 @@ namespace dist_object {
 		dist_object(std::string base, data_type const &data)
 			: base_type(create_server(data)), base_(base) {
 			assert( C == construction_type::All_to_All || 
-				    C == construction_type::Meta_Object);
+				    C == construction_type::Meta_Object ||
+				    C == construction_type::Tree);
 			size_t num_locs = hpx::find_all_localities().size();
-			//std::vector<size_t> my_locs(num_locs);
-			//std::iota(my_locs.begin(), my_locs.end(), 0);
+			localities_.resize(num_locs);
+			std::iota(localities_.begin(), localities_.end(), 0);
 			//size_t here_ = hpx::get_locality_id();
 			if (C == construction_type::Meta_Object) {
 				meta_object mo(base, num_locs, 0);
-				locs = mo.registration(get_id());
 				basename_registration_helper(base);
+				seed_ids(mo.registration(get_id()).get());
+			}
+			else if (C == construction_type::Tree) {
+				tree_registration tr(base, localities_);
+				basename_registration_helper(base);
+				seed_ids(tr.registration(get_id()).get());
 			}
 			else{
 				basename_registration_helper(base);
@@ -219,6 +544,34 @@ namespace dist_object {
 			basename_registration_helper(base);
 		}
 
+		// Asynchronous construction. The returned future becomes ready once
+		// the partitions of all participating localities are registered, so
+		// the object can be used right away, without a barrier. Several
+		// objects can be constructed concurrently this way
+		static hpx::future<dist_object> create(std::string base,
+			data_type const& data, std::vector<size_t> localities)
+		{
+			HPX_ASSERT(!localities.empty());
+			std::sort(localities.begin(), localities.end());
+			return create_server(data).then(
+				[base, localities](hpx::future<hpx::id_type> f)
+				{
+					dist_object obj(f.get());
+					obj.base_ = base;
+					obj.localities_ = localities;
+					return obj.register_async();
+				});
+		}
+
+		static hpx::future<dist_object> create(std::string base,
+			data_type const& data)
+		{
+			std::vector<size_t> localities(hpx::find_all_localities().size());
+			std::iota(localities.begin(), localities.end(), 0);
+			return create(std::move(base), data, std::move(localities));
+		}
+
+
 		dist_object(hpx::future<hpx::id_type> &&id)
 			: base_type(std::move(id))
 		{
@@ -227,7 +580,6 @@ namespace dist_object {
 		dist_object(hpx::id_type &&id)
 			: base_type(std::move(id))
 		{
-			basename_registration_helper(base);
 		}
 
 		size_t size() {
@@ -263,64 +615,950 @@ namespace dist_object {
 		}
 
 
-		// Uses the local basename_list to find the id for the locality
+		// Resolves the ids of the partitions owned by all participating
+		// localities at once. The lookups are issued concurrently and cached,
+		// so that later requests do not pay for them on their critical path.
+		// The returned future becomes ready once all ids are known
+		hpx::future<void> resolve_all()
+		{
+			HPX_ASSERT(this->get_id());
+			std::vector<hpx::shared_future<hpx::id_type>> ids;
+			ids.reserve(localities_.size());
+			for (std::size_t loc : localities_)
+				ids.push_back(get_basename_helper(static_cast<int>(loc)));
+
+			return hpx::when_all(ids).then(hpx::launch::sync,
+				[](hpx::future<std::vector<hpx::shared_future<hpx::id_type>>> f)
+				{
+					// rethrow any failed lookup
+					for (auto const& id : f.get())
+						id.get();
+				});
+		}
+
+		// Uses the id cache to find the id for the locality
 		// specified by the supplied index, and request that dist_object's
 		// local data
 		hpx::future<data_type> fetch(int idx)
 		{
 			HPX_ASSERT(this->get_id());
-			hpx::id_type lookup = get_basename_helper(idx);
-			typedef typename server::dist_object_part<T>::fetch_action
+			typedef typename server_type::fetch_action
+				action_type;
+			return async_on<action_type>(idx);
+		}
+
+		// Request only the elements [offset, offset + count) of the data
+		// owned by the locality specified by the supplied index. Requires
+		// data_type to be a sequence container whose ranged fetch action is
+		// registered with REGISTER_DIST_OBJECT_PART_RANGE
+		hpx::future<data_type> fetch(int idx, std::size_t offset,
+			std::size_t count)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::fetch_range_action
+				action_type;
+			return async_on<action_type>(idx, offset, count);
+		}
+
+		// Zero-copy variant of the ranged fetch for contiguous containers of
+		// trivially copyable elements. The remote elements are serialized
+		// directly out of the partition and received into a buffer owned by
+		// the caller. Requires REGISTER_DIST_OBJECT_PART_BUFFER
+		hpx::future<buffer_type> fetch_buffer(int idx, std::size_t offset,
+			std::size_t count)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::fetch_buffer_action
+				action_type;
+			return async_on<action_type>(idx, offset, count);
+		}
+
+		// Deserializes the elements [offset, offset + count) of the data owned
+		// by the locality specified by the supplied index directly into the
+		// memory pointed to by dest, which has to stay valid until the
+		// returned future becomes ready. Requires
+		// REGISTER_DIST_OBJECT_PART_BUFFER
+		hpx::future<void> fetch_into(int idx, std::size_t offset,
+			std::size_t count, element_type* dest)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::fetch_pointer_action
+				action_type;
+			return async_on<action_type>(idx, offset, count,
+				reinterpret_cast<std::size_t>(dest)).then(
+				[dest](hpx::future<pointer_buffer_type> f)
+				{
+					// local requests are not serialized, the buffer then
+					// still references the partition itself
+					pointer_buffer_type buffer = f.get();
+					if (buffer.data() != dest)
+						std::copy(buffer.data(), buffer.data() + buffer.size(),
+							dest);
+				});
+		}
+
+		// Overwrites the data owned by the locality specified by the supplied
+		// index. Requires REGISTER_DIST_OBJECT_PART_PUT
+		hpx::future<void> put(int idx, data_type const& value)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::put_action
+				action_type;
+			return async_on<action_type>(idx, value);
+		}
+
+		// Fire-and-forget variant of put, for bulk pushes which are
+		// synchronized by other means (e.g. a barrier)
+		void apply_put(int idx, data_type const& value)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::put_action
+				action_type;
+			apply_on<action_type>(idx, value);
+		}
+
+		// Overwrites the elements [offset, offset + values.size()) of the
+		// data owned by the locality specified by the supplied index.
+		// Requires REGISTER_DIST_OBJECT_PART_RANGE
+		hpx::future<void> put(int idx, std::size_t offset,
+			data_type const& values)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::put_range_action
+				action_type;
+			return async_on<action_type>(idx, offset, values);
+		}
+
+		// Overwrites the elements [offset, offset + count) of the data owned
+		// by the locality specified by the supplied index with the elements
+		// pointed to by data. Those are serialized in place and have to stay
+		// valid until the returned future becomes ready. Requires
+		// REGISTER_DIST_OBJECT_PART_BUFFER
+		hpx::future<void> put(int idx, std::size_t offset,
+			element_type const* data, std::size_t count)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::put_buffer_action
+				action_type;
+			return async_on<action_type>(idx, offset,
+				buffer_type(const_cast<element_type*>(data), count,
+					buffer_type::reference));
+		}
+
+		// Fire-and-forget variant of the ranged put. The elements are copied
+		// right away, so data may be reused as soon as this returns
+		void apply_put(int idx, std::size_t offset, element_type const* data,
+			std::size_t count)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::put_buffer_action
+				action_type;
+			apply_on<action_type>(idx, offset,
+				buffer_type(const_cast<element_type*>(data), count,
+					buffer_type::copy));
+		}
+
+		// Combines the data owned by the locality specified by the supplied
+		// index with value, on the owning locality. Requires
+		// REGISTER_DIST_OBJECT_PART_ATOMIC
+		hpx::future<void> accumulate(int idx, data_type const& value,
+			op_type op = op_type::plus)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::accumulate_action
+				action_type;
+			return async_on<action_type>(idx, value, op);
+		}
+
+		// Fire-and-forget variant of accumulate, e.g. for counters
+		void apply_accumulate(int idx, data_type const& value,
+			op_type op = op_type::plus)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::accumulate_action
+				action_type;
+			apply_on<action_type>(idx, value, op);
+		}
+
+		// Like accumulate, but returns the value the data had before
+		hpx::future<data_type> fetch_and_op(int idx, data_type const& value,
+			op_type op)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::fetch_and_op_action
+				action_type;
+			return async_on<action_type>(idx, value, op);
+		}
+
+		// Replaces the remote data with desired if it equals expected. The
+		// returned future holds the previous value, the exchange succeeded
+		// if that equals expected
+		hpx::future<data_type> compare_exchange(int idx,
+			data_type const& expected, data_type const& desired)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::compare_exchange_action
+				action_type;
+			return async_on<action_type>(idx, expected, desired);
+		}
+
+		// Element-wise variants for containers of arithmetic elements.
+		// Require REGISTER_DIST_OBJECT_PART_ELEMENT_ATOMIC
+
+		// Combines the elements [offset, offset + count) of the remote data
+		// with the ones pointed to by values, which have to stay valid until
+		// the returned future becomes ready
+		hpx::future<void> accumulate(int idx, std::size_t offset,
+			element_type const* values, std::size_t count,
+			op_type op = op_type::plus)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::accumulate_range_action
+				action_type;
+			return async_on<action_type>(idx, offset,
+				buffer_type(const_cast<element_type*>(values), count,
+					buffer_type::reference), op);
+		}
+
+		// Combines the remote elements at the given indices with values,
+		// e.g. to update a histogram
+		hpx::future<void> accumulate(int idx,
+			std::vector<std::size_t> const& indices,
+			std::vector<element_type> const& values,
+			op_type op = op_type::plus)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::accumulate_at_action
+				action_type;
+			return async_on<action_type>(idx, indices, values, op);
+		}
+
+		void apply_accumulate(int idx, std::vector<std::size_t> const& indices,
+			std::vector<element_type> const& values,
+			op_type op = op_type::plus)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::accumulate_at_action
 				action_type;
-			return hpx::async<action_type>(lookup);
+			apply_on<action_type>(idx, indices, values, op);
+		}
+
+		hpx::future<element_type> fetch_and_op(int idx, std::size_t index,
+			element_type const& value, op_type op)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::fetch_and_op_at_action
+				action_type;
+			return async_on<action_type>(idx, index, value, op);
+		}
+
+		hpx::future<element_type> compare_exchange(int idx, std::size_t index,
+			element_type const& expected, element_type const& desired)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::compare_exchange_at_action
+				action_type;
+			return async_on<action_type>(idx, index, expected, desired);
+		}
+
+		// Collectives over the partitions of all participating localities.
+		// They have to be called by every participating locality, in the
+		// same order. op is applied locally, it has to be associative and
+		// (except for all_reduce) commutative, see element_wise for
+		// containers. Requires REGISTER_DIST_OBJECT_PART_COLLECTIVES
+
+		// Combines the data of all partitions along a binomial tree rooted at
+		// the given locality, which takes O(log N) steps. The future returned
+		// on the root holds the result, on the other localities it holds the
+		// partial result of their subtree
+		template <typename Op>
+		hpx::future<data_type> reduce(std::size_t root, Op op)
+		{
+			HPX_ASSERT(this->get_id());
+			ensure_ptr();
+			return reduce_helper(next_sequence(), rank_of(root),
+				hpx::make_ready_future(ptr->fetch()), op);
+		}
+
+		// Combines the data of all partitions, the result becomes available
+		// on every locality. Uses recursive doubling if the number of
+		// localities is a power of two and reduce followed by broadcast
+		// otherwise, both O(log N) steps
+		template <typename Op>
+		hpx::future<data_type> all_reduce(Op op)
+		{
+			HPX_ASSERT(this->get_id());
+			ensure_ptr();
+			std::size_t const n = localities_.size();
+			hpx::future<data_type> result =
+				hpx::make_ready_future(ptr->fetch());
+
+			if ((n & (n - 1)) != 0) {
+				std::uint64_t const reduce_seq = next_sequence();
+				std::uint64_t const broadcast_seq = next_sequence();
+				result = reduce_helper(reduce_seq, 0, std::move(result), op);
+
+				// only the first locality holds the result, the others hold
+				// the partial result they sent
+				std::vector<hpx::future<data_type>> sends;
+				if (rank_of(hpx::get_locality_id()) != 0)
+					sends.push_back(std::move(result));
+				return wait_for_sends(broadcast_helper(broadcast_seq, 0,
+					std::move(result)), std::move(sends));
+			}
+
+			std::uint64_t const seq = next_sequence();
+			std::size_t const rank = rank_of(hpx::get_locality_id());
+			std::vector<hpx::future<data_type>> sends;
+			std::uint64_t round = 0;
+			for (std::size_t mask = 1; mask < n; mask <<= 1, ++round) {
+				std::uint64_t const tag = make_tag(seq, round);
+				std::size_t const partner = rank ^ mask;
+				hpx::shared_future<data_type> current = result.share();
+				sends.push_back(send(localities_[partner], tag, current));
+
+				// both partners combine in the same order, the results
+				// agree even if op is not commutative
+				bool const lower = partner < rank;
+				result = hpx::dataflow(hpx::launch::sync,
+					[op, lower](hpx::shared_future<data_type> mine,
+						hpx::future<data_type> theirs)
+					{
+						return lower ? op(theirs.get(), mine.get()) :
+							op(mine.get(), theirs.get());
+					},
+					current, ptr->receive(tag));
+			}
+			return wait_for_sends(std::move(result), std::move(sends));
+		}
+
+		// Distributes the data of the partition on the given locality along
+		// a binomial tree, the returned future holds it on every locality.
+		// The partitions themselves are not modified
+		hpx::future<data_type> broadcast(std::size_t root)
+		{
+			HPX_ASSERT(this->get_id());
+			ensure_ptr();
+			std::size_t const root_rank = rank_of(root);
+			hpx::future<data_type> value;
+			if (rank_of(hpx::get_locality_id()) == root_rank)
+				value = hpx::make_ready_future(ptr->fetch());
+			return broadcast_helper(next_sequence(), root_rank,
+				std::move(value));
+		}
+
+		// Prefix combination of the data of all partitions in the order of
+		// the participating localities: the result on the i-th locality is
+		// the combination of the partitions 0..i. Uses recursive doubling,
+		// which takes O(log N) steps, op only has to be associative
+		template <typename Op>
+		hpx::future<data_type> inclusive_scan(Op op)
+		{
+			HPX_ASSERT(this->get_id());
+			ensure_ptr();
+			return scan_helper(next_sequence(), ptr->fetch(), op, true);
+		}
+
+		// Like inclusive_scan, but the result on the i-th locality combines
+		// init with the partitions 0..i-1, the first locality receives init
+		template <typename Op>
+		hpx::future<data_type> exclusive_scan(data_type const& init, Op op)
+		{
+			HPX_ASSERT(this->get_id());
+			ensure_ptr();
+			std::uint64_t const seq = next_sequence();
+			if (rank_of(hpx::get_locality_id()) != 0)
+				return scan_helper(seq, ptr->fetch(), op, false);
+
+			// the first locality only feeds the others
+			return scan_helper(seq, op(init, ptr->fetch()), op, false).then(
+				hpx::launch::sync,
+				[init](hpx::future<data_type> f)
+				{
+					f.get();
+					return init;
+				});
+		}
+
+		// Collectives for container partitions (e.g. std::vector<T>). The
+		// partitions are collected into one contiguous buffer, in the order
+		// of the participating localities, see gathered
+
+		// Collects the partitions of all localities on the given one. The
+		// localities send their partition straight to root concurrently, the
+		// future returned on the other localities holds an empty result
+		hpx::future<gathered<element_type>> gather(std::size_t root)
+		{
+			HPX_ASSERT(this->get_id());
+			ensure_ptr();
+			std::size_t const n = localities_.size();
+			std::size_t const rank = rank_of(hpx::get_locality_id());
+			std::size_t const root_rank = rank_of(root);
+			std::uint64_t const seq = next_sequence();
+
+			hpx::shared_future<data_type> local =
+				hpx::make_ready_future(ptr->fetch());
+			if (rank != root_rank) {
+				std::vector<hpx::future<data_type>> sends;
+				sends.push_back(send(root, make_tag(seq, rank), local));
+				return wait_for_sends(
+					hpx::make_ready_future(gathered<element_type>()),
+					std::move(sends));
+			}
+
+			std::vector<hpx::shared_future<data_type>> blocks(n);
+			for (std::size_t i = 0; i != n; ++i) {
+				blocks[i] = (i == rank) ? local :
+					ptr->receive(make_tag(seq, i)).share();
+			}
+			return assemble(std::move(blocks));
+		}
+
+		// Collects the partitions of all localities on every locality. Uses
+		// a ring: in each of the N - 1 steps every locality forwards the
+		// partition it received last to its right neighbor, so each link
+		// carries every partition exactly once
+		hpx::future<gathered<element_type>> all_gather()
+		{
+			HPX_ASSERT(this->get_id());
+			ensure_ptr();
+			std::size_t const n = localities_.size();
+			std::size_t const rank = rank_of(hpx::get_locality_id());
+			std::size_t const right = localities_[(rank + 1) % n];
+			std::uint64_t const seq = next_sequence();
+
+			std::vector<hpx::shared_future<data_type>> blocks(n);
+			blocks[rank] = hpx::make_ready_future(ptr->fetch());
+
+			std::vector<hpx::future<data_type>> sends;
+			sends.reserve(n - 1);
+			for (std::size_t step = 0; step + 1 < n; ++step) {
+				std::uint64_t const tag = make_tag(seq, step);
+				sends.push_back(
+					send(right, tag, blocks[(rank + n - step) % n]));
+				blocks[(rank + n - step - 1) % n] =
+					ptr->receive(tag).share();
+			}
+			return wait_for_sends(assemble(std::move(blocks)),
+				std::move(sends));
+		}
+
+		// Distributes data, which is only used on root, to all localities.
+		// Each locality receives the elements [data.offsets[i],
+		// data.offsets[i + 1]) where i is its position among the
+		// participating localities. The partitions are not modified
+		hpx::future<data_type> scatter(std::size_t root,
+			gathered<element_type> const& data = gathered<element_type>())
+		{
+			HPX_ASSERT(this->get_id());
+			ensure_ptr();
+			std::size_t const n = localities_.size();
+			std::size_t const rank = rank_of(hpx::get_locality_id());
+			std::uint64_t const seq = next_sequence();
+
+			if (rank != rank_of(root))
+				return ptr->receive(make_tag(seq, 0));
+
+			HPX_ASSERT(data.offsets.size() == n + 1);
+			std::vector<hpx::future<data_type>> sends;
+			sends.reserve(n - 1);
+			for (std::size_t i = 0; i != n; ++i) {
+				if (i == rank)
+					continue;
+				sends.push_back(send(localities_[i], make_tag(seq, 0),
+					hpx::make_ready_future(data.slice(i)).share()));
+			}
+			return wait_for_sends(hpx::make_ready_future(data.slice(rank)),
+				std::move(sends));
+		}
+
+		// Personalized all-to-all exchange: the elements [send_offsets[i],
+		// send_offsets[i] + send_counts[i]) of the local partition are sent
+		// to the i-th participating locality. The result holds what was
+		// received from each locality, in their order. Uses a pairwise
+		// schedule: in step k every locality sends to the one k positions to
+		// its right and receives from the one k positions to its left, at
+		// most max_concurrent sends being in flight at any time. The local
+		// partition must not be modified before the returned future is ready
+		hpx::future<gathered<element_type>> all_to_all(
+			std::vector<std::size_t> const& send_offsets,
+			std::vector<std::size_t> const& send_counts,
+			std::size_t max_concurrent = 8)
+		{
+			HPX_ASSERT(this->get_id());
+			ensure_ptr();
+			std::size_t const n = localities_.size();
+			std::size_t const rank = rank_of(hpx::get_locality_id());
+			std::uint64_t const seq = next_sequence();
+			HPX_ASSERT(send_offsets.size() == n && send_counts.size() == n);
+			if (max_concurrent == 0)
+				max_concurrent = 1;
+
+			// each slice is cut from the partition itself when it is sent,
+			// under its read lock, the partition is never copied as a whole
+			std::shared_ptr<server_type> part = ptr;
+			auto slice = [part](std::size_t offset, std::size_t count)
+			{
+				return part->fetch_range(offset, count);
+			};
+
+			std::vector<hpx::shared_future<data_type>> blocks(n);
+			blocks[rank] = hpx::make_ready_future(
+				slice(send_offsets[rank], send_counts[rank]));
+
+			std::vector<hpx::shared_future<data_type>> sends;
+			sends.reserve(n - 1);
+			for (std::size_t k = 1; k < n; ++k) {
+				std::uint64_t const tag = make_tag(seq, k);
+				std::size_t const dest = (rank + k) % n;
+				std::size_t const offset = send_offsets[dest];
+				std::size_t const count = send_counts[dest];
+
+				// the payload is only cut once the send max_concurrent steps
+				// earlier was delivered
+				hpx::shared_future<data_type> payload;
+				if (k > max_concurrent) {
+					payload = sends[k - 1 - max_concurrent].then(
+						hpx::launch::sync,
+						[slice, offset, count](hpx::shared_future<data_type> f)
+						{
+							f.get();
+							return slice(offset, count);
+						});
+				}
+				else {
+					payload = hpx::make_ready_future(slice(offset, count));
+				}
+
+				sends.push_back(send(localities_[dest], tag, payload).share());
+				blocks[(rank + n - k) % n] = ptr->receive(tag).share();
+			}
+			return wait_for_sends(assemble(std::move(blocks)),
+				std::move(sends));
+		}
+
+		// Scan over the elements of all partitions as if they were one
+		// sequence, in the order of the participating localities. The
+		// returned future holds the scanned elements of the local partition,
+		// which is not modified. The local passes run in parallel, only the
+		// totals of the partitions take part in the O(log N) cross-locality
+		// scan. op has to be associative
+		template <typename Op>
+		hpx::future<data_type> segmented_inclusive_scan(Op op)
+		{
+			HPX_ASSERT(this->get_id());
+			ensure_ptr();
+			std::uint64_t const seq = next_sequence();
+			std::shared_ptr<data_type> local =
+				std::make_shared<data_type>(ptr->fetch());
+			hpx::parallel::inclusive_scan(hpx::parallel::execution::par,
+				std::begin(*local), std::end(*local), std::begin(*local), op);
+
+			return segment_prefix(seq, *local, op).then(
+				[local, op](hpx::future<data_type> f)
+				{
+					data_type prefix = f.get();
+					if (!prefix.empty()) {
+						element_type const& p = *std::begin(prefix);
+						hpx::parallel::transform(hpx::parallel::execution::par,
+							std::begin(*local), std::end(*local),
+							std::begin(*local),
+							[&p, &op](element_type const& x)
+							{
+								return op(p, x);
+							});
+					}
+					return std::move(*local);
+				});
+		}
+
+		// Like segmented_inclusive_scan, but each element is replaced by the
+		// combination of init with all elements preceding it
+		template <typename Op>
+		hpx::future<data_type> segmented_exclusive_scan(
+			element_type const& init, Op op)
+		{
+			HPX_ASSERT(this->get_id());
+			ensure_ptr();
+			std::uint64_t const seq = next_sequence();
+			std::shared_ptr<data_type> local =
+				std::make_shared<data_type>(ptr->fetch());
+			hpx::parallel::inclusive_scan(hpx::parallel::execution::par,
+				std::begin(*local), std::end(*local), std::begin(*local), op);
+
+			return segment_prefix(seq, *local, op).then(
+				[local, init, op](hpx::future<data_type> f)
+				{
+					data_type prefix = f.get();
+					element_type const start = prefix.empty() ? init :
+						op(init, *std::begin(prefix));
+
+					// shift the inclusive result by one element
+					data_type result(*local);
+					if (!local->empty()) {
+						*std::begin(result) = start;
+						hpx::parallel::transform(hpx::parallel::execution::par,
+							std::begin(*local), std::prev(std::end(*local)),
+							std::next(std::begin(result)),
+							[&start, &op](element_type const& x)
+							{
+								return op(start, x);
+							});
+					}
+					return result;
+				});
 		}
 
 	private:
-		mutable std::shared_ptr<server::dist_object_part<T>> ptr;
+		mutable std::shared_ptr<server_type> ptr;
 		std::string base_;
 		std::string base_unpacked;
 		void ensure_ptr() const {
 			if (!ptr) {
-				ptr = hpx::get_ptr<server::dist_object_part<T>>(
+				ptr = hpx::get_ptr<server_type>(
 					hpx::launch::sync, get_id());
 			}
 		}
 	private:
-		std::vector<hpx::id_type> basename_list;
-		std::unordered_map<std::size_t, hpx::id_type> locs;
+		std::shared_ptr<detail::id_cache> ids_;
+		std::vector<std::size_t> localities_;
+
+		// Returns the (future) id of the partition owned by the locality
+		// specified by the supplied index, looking it up on first use
+		hpx::shared_future<hpx::id_type> get_basename_helper(int idx) {
+			HPX_ASSERT(ids_);
+			std::string const& base = base_;
+			return ids_->get(idx, [&base, idx]() {
+				return hpx::find_from_basename(base + std::to_string(idx), idx);
+			});
+		}
+
+		// Invokes the action on the partition owned by the locality specified
+		// by the supplied index, chained to the lookup of its id if that is
+		// not known yet
+		template <typename Action, typename... Ts>
+		auto async_on(int idx, Ts const&... vs)
+			-> decltype(hpx::async<Action>(std::declval<hpx::id_type>(), vs...))
+		{
+			hpx::shared_future<hpx::id_type> id = get_basename_helper(idx);
+			if (id.is_ready())
+				return hpx::async<Action>(id.get(), vs...);
+			return id.then(
+				[=](hpx::shared_future<hpx::id_type> f)
+				{
+					return hpx::async<Action>(f.get(), vs...);
+				});
+		}
+
+		template <typename Action, typename... Ts>
+		void apply_on(int idx, Ts const&... vs)
+		{
+			hpx::shared_future<hpx::id_type> id = get_basename_helper(idx);
+			if (id.is_ready()) {
+				hpx::apply<Action>(id.get(), vs...);
+				return;
+			}
+			id.then(
+				[=](hpx::shared_future<hpx::id_type> f)
+				{
+					hpx::apply<Action>(f.get(), vs...);
+				});
+		}
+
+		// Each collective call takes the next sequence number, which
+		// together with the step of the algorithm tags its messages
+		std::shared_ptr<std::atomic<std::uint64_t>> sequence_;
+
+		std::uint64_t next_sequence() {
+			return (*sequence_)++;
+		}
+
+		static std::uint64_t make_tag(std::uint64_t seq, std::uint64_t round) {
+			HPX_ASSERT(round < (std::uint64_t(1) << 32));
+			return (seq << 32) | round;
+		}
+
+		// Position of the given locality among the participating ones
+		std::size_t rank_of(std::size_t loc) const {
+			auto it = std::lower_bound(localities_.begin(), localities_.end(),
+				loc);
+			HPX_ASSERT(it != localities_.end() && *it == loc);
+			return static_cast<std::size_t>(
+				std::distance(localities_.begin(), it));
+		}
+
+		// Deposits the value with the partition on the given locality once
+		// it is ready, the returned future holds the value once delivered
+		hpx::future<data_type> send(std::size_t loc, std::uint64_t tag,
+			hpx::shared_future<data_type> value) {
+			dist_object self(*this);
+			return value.then(
+				[self, loc, tag](hpx::shared_future<data_type> f) mutable
+				{
+					data_type v = f.get();
+					typedef typename server_type::deposit_action action_type;
+					return self.template async_on<action_type>(
+						static_cast<int>(loc), tag, v).then(hpx::launch::sync,
+						[v](hpx::future<void> sent)
+						{
+							sent.get();
+							return v;
+						});
+				});
+		}
+
+		// Makes result ready only after all sends went out, which
+		// propagates their errors
+		template <typename Result, typename Send>
+		static hpx::future<Result> wait_for_sends(
+			hpx::future<Result> result, std::vector<Send> sends) {
+			return hpx::dataflow(hpx::launch::sync,
+				[](hpx::future<Result> r, hpx::future<std::vector<Send>> s)
+				{
+					for (Send& f : s.get())
+						f.get();
+					return r.get();
+				},
+				std::move(result), hpx::when_all(std::move(sends)));
+		}
+
+		// Concatenates the partitions, which are given in rank order
+		static hpx::future<gathered<element_type>> assemble(
+			std::vector<hpx::shared_future<data_type>> blocks) {
+			return hpx::when_all(std::move(blocks)).then(hpx::launch::sync,
+				[](hpx::future<std::vector<hpx::shared_future<data_type>>> f)
+				{
+					std::vector<hpx::shared_future<data_type>> blocks = f.get();
+					gathered<element_type> result;
+					result.offsets.reserve(blocks.size() + 1);
+					result.offsets.push_back(0);
+					for (hpx::shared_future<data_type> const& b : blocks) {
+						result.offsets.push_back(
+							result.offsets.back() + b.get().size());
+					}
+					result.data.reserve(result.offsets.back());
+					for (hpx::shared_future<data_type> const& b : blocks) {
+						result.data.insert(result.data.end(),
+							std::begin(b.get()), std::end(b.get()));
+					}
+					return result;
+				});
+		}
+
+		// Binomial tree reduction, ranks are relative to root_rank
+		template <typename Op>
+		hpx::future<data_type> reduce_helper(std::uint64_t seq,
+			std::size_t root_rank, hpx::future<data_type> value, Op op) {
+			std::size_t const n = localities_.size();
+			std::size_t const rel =
+				(rank_of(hpx::get_locality_id()) + n - root_rank) % n;
+
+			std::uint64_t round = 0;
+			for (std::size_t mask = 1; mask < n; mask <<= 1, ++round) {
+				std::uint64_t const tag = make_tag(seq, round);
+				if (rel & mask) {
+					// hand the partial result to the parent, this is done
+					std::size_t const parent = (rel - mask + root_rank) % n;
+					return send(localities_[parent], tag, value.share());
+				}
+				if (rel + mask < n) {
+					value = hpx::dataflow(hpx::launch::sync,
+						[op](hpx::future<data_type> lhs,
+							hpx::future<data_type> rhs)
+						{
+							return op(lhs.get(), rhs.get());
+						},
+						std::move(value), ptr->receive(tag));
+				}
+			}
+			return value;
+		}
+
+		// Binomial tree broadcast, value is only used on root_rank
+		hpx::future<data_type> broadcast_helper(std::uint64_t seq,
+			std::size_t root_rank, hpx::future<data_type> value) {
+			std::size_t const n = localities_.size();
+			std::size_t const rel =
+				(rank_of(hpx::get_locality_id()) + n - root_rank) % n;
+
+			// receive from the parent, the lowest set bit of rel
+			std::size_t mask = 1;
+			std::uint64_t round = 0;
+			while (mask < n) {
+				if (rel & mask) {
+					value = ptr->receive(make_tag(seq, round));
+					break;
+				}
+				mask <<= 1;
+				++round;
+			}
+
+			// forward to the children, largest subtree first
+			hpx::shared_future<data_type> shared = value.share();
+			std::vector<hpx::future<data_type>> sends;
+			while (mask > 1) {
+				mask >>= 1;
+				--round;
+				if (rel + mask < n) {
+					sends.push_back(send(localities_[(rel + mask + root_rank) % n],
+						make_tag(seq, round), shared));
+				}
+			}
+
+			return wait_for_sends(shared.then(hpx::launch::sync,
+				[](hpx::shared_future<data_type> f) { return f.get(); }),
+				std::move(sends));
+		}
 
-		hpx::id_type get_basename_helper(int idx) {
-			if (!locs[idx]) {
-				//basename_list[idx] = hpx::find_from_basename(base_ + std::to_string(idx), idx).get();
-				locs[idx] = hpx::find_from_basename(base_ + std::to_string(idx), idx).get();
-			//if (!basename_list[idx]) {
-			//	basename_list[idx] = hpx::find_from_basename(base_ + 
-			//		std::to_string(idx), idx).get();
+		// Recursive doubling scan: in round r every locality sends its
+		// partial result to the one 2^r positions to its right and combines
+		// what it receives from the left in front of it. The exclusive
+		// variant additionally combines everything received, the result on
+		// the first locality is then undefined and has to be replaced
+		template <typename Op>
+		hpx::future<data_type> scan_helper(std::uint64_t seq, data_type value,
+			Op op, bool inclusive) {
+			std::size_t const n = localities_.size();
+			std::size_t const rank = rank_of(hpx::get_locality_id());
+			auto combine = [op](hpx::shared_future<data_type> lhs,
+				hpx::shared_future<data_type> rhs)
+			{
+				return op(lhs.get(), rhs.get());
+			};
+
+			hpx::shared_future<data_type> partial =
+				hpx::make_ready_future(std::move(value));
+			hpx::shared_future<data_type> prefix;
+			std::vector<hpx::future<data_type>> sends;
+			std::uint64_t round = 0;
+			for (std::size_t dist = 1; dist < n; dist <<= 1, ++round) {
+				std::uint64_t const tag = make_tag(seq, round);
+				if (rank + dist < n)
+					sends.push_back(send(localities_[rank + dist], tag, partial));
+				if (rank >= dist) {
+					hpx::shared_future<data_type> received =
+						ptr->receive(tag).share();
+					partial = hpx::dataflow(hpx::launch::sync, combine,
+						received, partial).share();
+					if (!inclusive) {
+						prefix = prefix.valid() ? hpx::dataflow(
+							hpx::launch::sync, combine, received,
+							prefix).share() : received;
+					}
+				}
+			}
+
+			hpx::shared_future<data_type> result =
+				(inclusive || !prefix.valid()) ? partial : prefix;
+			return wait_for_sends(result.then(hpx::launch::sync,
+				[](hpx::shared_future<data_type> f) { return f.get(); }),
+				std::move(sends));
+		}
+
+		// Combination of the elements of all partitions on the localities
+		// before this one, given the inclusively scanned local partition.
+		// Holds at most one element, none on the first locality or if all of
+		// the preceding partitions are empty
+		template <typename Op>
+		hpx::future<data_type> segment_prefix(std::uint64_t seq,
+			data_type const& scanned, Op op) {
+			data_type total;
+			if (!scanned.empty())
+				total = data_type(1, *std::prev(std::end(scanned)));
+
+			auto combine = [op](data_type const& lhs, data_type const& rhs)
+			{
+				if (lhs.empty())
+					return rhs;
+				if (rhs.empty())
+					return lhs;
+				return data_type(1, op(*std::begin(lhs), *std::begin(rhs)));
+			};
+			if (rank_of(hpx::get_locality_id()) == 0) {
+				return scan_helper(seq, std::move(total), combine, false).then(
+					hpx::launch::sync,
+					[](hpx::future<data_type> f)
+					{
+						f.get();
+						return data_type();
+					});
+			}
+			return scan_helper(seq, std::move(total), combine, false);
+		}
+
+		// Registers this partition according to the construction type, the
+		// returned future becomes ready once all peers are known
+		hpx::future<dist_object> register_async() {
+			basename_registration_helper(base_);
+
+			hpx::future<void> registered;
+			if (C == construction_type::Meta_Object) {
+				meta_object mo(base_, localities_.size(), localities_[0]);
+				dist_object self(*this);
+				registered = mo.registration(get_id()).then(
+					hpx::launch::sync,
+					[self](hpx::future<meta_object::table_type> f) mutable
+					{
+						self.seed_ids(f.get());
+					});
 			}
-			//return basename_list[idx];
-			return locs[idx];
+			else if (C == construction_type::Tree) {
+				tree_registration tr(base_, localities_);
+				dist_object self(*this);
+				registered = tr.registration(get_id()).then(
+					hpx::launch::sync,
+					[self](hpx::future<tree_registration::table_type> f) mutable
+					{
+						self.seed_ids(f.get());
+					});
+			}
+			else {
+				// the lookups complete only once the peers registered
+				registered = resolve_all();
+			}
+
+			dist_object self(*this);
+			return registered.then(hpx::launch::sync,
+				[self](hpx::future<void> f)
+				{
+					f.get();
+					return self;
+				});
+		}
+
+		void seed_ids(std::unordered_map<std::size_t, hpx::id_type> const& ids) {
+			for (auto const& id : ids)
+				ids_->set(id.first, id.second);
 		}
 		void basename_registration_helper(std::string base) {
 			base_unpacked = base + std::to_string(hpx::get_locality_id());
 			hpx::register_with_basename(base + std::to_string(
 				hpx::get_locality_id()), get_id());
-			basename_list.resize(hpx::find_all_localities().size());
+			std::size_t num_locs = hpx::find_all_localities().size();
+			ids_ = std::make_shared<detail::id_cache>(num_locs);
+			ids_->set(hpx::get_locality_id(), get_id());
+			sequence_ = std::make_shared<std::atomic<std::uint64_t>>(0);
+			if (localities_.empty()) {
+				localities_.resize(num_locs);
+				std::iota(localities_.begin(), localities_.end(), 0);
+			}
 		}
 	};
 
-	template <typename T, construction_type C>
-	class dist_object<T&, C>
-		: hpx::components::client_base<dist_object<T&>, 
-		server::dist_object_part<T&>> {
-		typedef hpx::components::client_base<dist_object<T&>, 
-			server::dist_object_part<T&>> base_type;
+	template <typename T, construction_type C, typename Policy>
+	class dist_object<T&, C, Policy>
+		: hpx::components::client_base<dist_object<T&, C, Policy>,
+			server::dist_object_part<T&, Policy>> {
+		typedef server::dist_object_part<T&, Policy> server_type;
+		typedef hpx::components::client_base<dist_object<T&, C, Policy>,
+			server_type> base_type;
 
-		typedef typename server::dist_object_part<T&>::data_type data_type;
+		typedef typename server_type::data_type data_type;
 
 	private:
 		template <typename Arg>
 		static hpx::future<hpx::id_type> create_server(Arg& value) {
-			return hpx::local_new <server::dist_object_part<T&>>(value);
+			return hpx::local_new <server_type>(value);
 		}
 
 	public:
@@ -330,19 +1568,26 @@ namespace dist_object {
 			: base_type(create_server(data)), base_(base)
 		{
 			assert(C == construction_type::All_to_All ||
-				C == construction_type::Meta_Object);
+				C == construction_type::Meta_Object ||
+				C == construction_type::Tree);
 			assert(localities.size() > 0);
 			assert(std::find(localities.begin(), localities.end(),
 				hpx::get_locality_id()) != localities.end());
 
 			std::sort(localities.begin(), localities.end());
+			localities_ = localities;
 
 			if (C == construction_type::Meta_Object) {
 				meta_object mo(base, localities.size(), localities[0]);
-				locs = mo.registration(get_id());
 				basename_registration_helper(base);
+				seed_ids(mo.registration(get_id()).get());
 			}
-			else(type == construction_type::All_to_All) {
+			else if (C == construction_type::Tree) {
+				tree_registration tr(base, localities_);
+				basename_registration_helper(base);
+				seed_ids(tr.registration(get_id()).get());
+			}
+			else {
 				basename_registration_helper(base);
 			}
 		}
@@ -351,15 +1596,21 @@ namespace dist_object {
 			: base_type(create_server(data)), base_(base) 
 		{
 			assert(C == construction_type::All_to_All || 
-				   C == construction_type::Meta_Object);
+				   C == construction_type::Meta_Object ||
+				   C == construction_type::Tree);
 			size_t num_locs = hpx::find_all_localities().size();
-			//std::vector<size_t> my_locs(num_locs);
-			//std::iota(my_locs.begin(), my_locs.end(), 0);
+			localities_.resize(num_locs);
+			std::iota(localities_.begin(), localities_.end(), 0);
 			//size_t here_ = hpx::get_locality_id();
 			if (C == construction_type::Meta_Object) {
 				meta_object mo(base, num_locs, 0);
-				locs = mo.registration(get_id());
 				basename_registration_helper(base);
+				seed_ids(mo.registration(get_id()).get());
+			}
+			else if (C == construction_type::Tree) {
+				tree_registration tr(base, localities_);
+				basename_registration_helper(base);
+				seed_ids(tr.registration(get_id()).get());
 			}
 			else {
 				basename_registration_helper(base);
@@ -403,57 +1654,84 @@ namespace dist_object {
 		}
 
 
-		// Uses the local basename_list to find the id for the locality
+		// Uses the id cache to find the id for the locality
 		// specified by the supplied index, and request that dist_object's
 		// local data
 		hpx::future<T> fetch(int idx)
 		{
 			HPX_ASSERT(this->get_id());
-			hpx::id_type lookup = get_basename_helper(idx);
-			typedef typename server::dist_object_part<T&>::fetch_ref_action
+			typedef typename server_type::fetch_action
 				action_type;
-			return hpx::async<action_type>(lookup);
+			return async_on<action_type>(idx);
 		}
 
 	private:
-		mutable std::shared_ptr<server::dist_object_part<T&>> ptr;
+		mutable std::shared_ptr<server_type> ptr;
 		std::string base_;
 		std::string base_unpacked;
 		void ensure_ptr() const {
 			if (!ptr) {
-				ptr = hpx::get_ptr<server::dist_object_part<T&>>(
+				ptr = hpx::get_ptr<server_type>(
 					hpx::launch::sync, get_id());
 			}
 		}
 	private:
-		std::vector<hpx::id_type> basename_list;
-
-		//hpx::id_type get_basename_helper(int idx) {
-		//	if (!basename_list[idx]) {
-		//		basename_list[idx] = hpx::find_from_basename(base_ + 
-		//			std::to_string(idx), idx).get();
-		//	}
-		//	return basename_list[idx];
-		//}
-		//void basename_registration_helper(std::string base) {
-		//	hpx::register_with_basename(base + std::to_string(
-		//		hpx::get_locality_id()), get_id());
-		//	basename_list.resize(hpx::find_all_localities().size());
-		//}
+		std::shared_ptr<detail::id_cache> ids_;
+		std::vector<std::size_t> localities_;
+
+		// Returns the (future) id of the partition owned by the locality
+		// specified by the supplied index, looking it up on first use
+		hpx::shared_future<hpx::id_type> get_basename_helper(int idx) {
+			HPX_ASSERT(ids_);
+			std::string const& base = base_;
+			return ids_->get(idx, [&base, idx]() {
+				return hpx::find_from_basename(base + std::to_string(idx), idx);
+			});
+		}
 
-		std::unordered_map<std::size_t, hpx::id_type> locs;
+		// Invokes the action on the partition owned by the locality specified
+		// by the supplied index, chained to the lookup of its id if that is
+		// not known yet
+		template <typename Action, typename... Ts>
+		auto async_on(int idx, Ts const&... vs)
+			-> decltype(hpx::async<Action>(std::declval<hpx::id_type>(), vs...))
+		{
+			hpx::shared_future<hpx::id_type> id = get_basename_helper(idx);
+			if (id.is_ready())
+				return hpx::async<Action>(id.get(), vs...);
+			return id.then(
+				[=](hpx::shared_future<hpx::id_type> f)
+				{
+					return hpx::async<Action>(f.get(), vs...);
+				});
+		}
 
-		hpx::id_type get_basename_helper(int idx) {
-			if (!locs[idx]) {
-				locs[idx] = hpx::find_from_basename(base_ + std::to_string(idx), idx).get();
+		template <typename Action, typename... Ts>
+		void apply_on(int idx, Ts const&... vs)
+		{
+			hpx::shared_future<hpx::id_type> id = get_basename_helper(idx);
+			if (id.is_ready()) {
+				hpx::apply<Action>(id.get(), vs...);
+				return;
 			}
-			return locs[idx];
+			id.then(
+				[=](hpx::shared_future<hpx::id_type> f)
+				{
+					hpx::apply<Action>(f.get(), vs...);
+				});
+		}
+
+		void seed_ids(std::unordered_map<std::size_t, hpx::id_type> const& ids) {
+			for (auto const& id : ids)
+				ids_->set(id.first, id.second);
 		}
 		void basename_registration_helper(std::string base) {
 			base_unpacked = base + std::to_string(hpx::get_locality_id());
 			hpx::register_with_basename(base + std::to_string(
 				hpx::get_locality_id()), get_id());
-			basename_list.resize(hpx::find_all_localities().size());
+			ids_ = std::make_shared<detail::id_cache>(
+				hpx::find_all_localities().size());
+			ids_->set(hpx::get_locality_id(), get_id());
 		}
 	};
 }
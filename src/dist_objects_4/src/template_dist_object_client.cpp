@@ -19,6 +19,7 @@
 #include <hpx/hpx_init.hpp>
 #include <hpx/include/iostreams.hpp>
 #include <hpx/include/parallel_algorithm.hpp>
+#include <hpx/include/parallel_numeric.hpp>
 #include <hpx/lcos/barrier.hpp>
 #include <hpx/parallel/algorithms/for_each.hpp>
 
@@ -26,27 +27,43 @@
 #include <hpx/lcos/dataflow.hpp>
 #include <hpx/lcos/when_all.hpp>
 
+#include "dist_csr_matrix.hpp"
+#include "dist_matrix.hpp"
+#include "dist_unordered_map.hpp"
+#include "dist_vector.hpp"
 #include "template_dist_object.hpp"
 #include <boost/range/irange.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <functional>
 #include <iostream>
+#include <numeric>
 #include <string>
 #include <vector>
 
 REGISTER_DIST_OBJECT_PART(int);
+REGISTER_DIST_OBJECT_PART_ATOMIC(int);
+REGISTER_DIST_OBJECT_PART_COLLECTIVES(int);
 
 using myVectorInt = std::vector<int>;
 REGISTER_DIST_OBJECT_PART(myVectorInt);
+REGISTER_DIST_OBJECT_PART_ELEMENT_ATOMIC(myVectorInt);
+REGISTER_DIST_OBJECT_PART_COLLECTIVES(myVectorInt);
 using myMatrixInt = std::vector<std::vector<int>>;
 REGISTER_DIST_OBJECT_PART(myMatrixInt);
+REGISTER_DIST_OBJECT_PART_COLLECTIVES(myMatrixInt);
 
 REGISTER_DIST_OBJECT_PART(double);
 using myVectorDouble = std::vector<double>;
 REGISTER_DIST_OBJECT_PART(myVectorDouble);
+REGISTER_DIST_OBJECT_PART_PUT(myVectorDouble);
+REGISTER_DIST_OBJECT_PART_RANGE(myVectorDouble);
+REGISTER_DIST_OBJECT_PART_BUFFER(myVectorDouble);
 using myMatrixDouble = std::vector<std::vector<double>>;
 REGISTER_DIST_OBJECT_PART(myMatrixDouble);
+REGISTER_DIST_OBJECT_PART_RANGE(myMatrixDouble);
 using myVectorDoubleConst = std::vector<double> const;
 REGISTER_DIST_OBJECT_PART(myVectorDoubleConst);
 
@@ -57,6 +74,13 @@ REGISTER_DIST_OBJECT_PART(myVectorIntRef);
 using myVectorDoubleConstRef = std::vector<double> const &;
 REGISTER_DIST_OBJECT_PART(myVectorDoubleConstRef);
 
+REGISTER_DIST_MATRIX(double, row_major);
+REGISTER_DIST_MATRIX(double, column_major);
+
+REGISTER_DIST_UNORDERED_MAP(int, double);
+
+REGISTER_DIST_CSR_MATRIX(double);
+
 void run_dist_object_int() {
   using dist_object::dist_object;
   // Construct a distrtibuted object of type int in all provided localities
@@ -142,6 +166,134 @@ void run_accumulation_reduce_to_locality0_parallel() {
   }
 }
 
+void run_collectives() {
+  using dist_object::dist_object;
+  int num_localities = static_cast<int>(hpx::find_all_localities().size());
+  int here = static_cast<int>(hpx::get_locality_id());
+  int len = 10;
+
+  int sum = 0;
+  for (int i = 0; i < num_localities; i++) {
+    sum += i;
+  }
+
+  // every locality takes part in every collective, in the same order
+  dist_object<int> dist_int =
+      dist_object<int>::create("collectives_int", here).get();
+
+  hpx::future<int> reduced = dist_int.reduce(0, std::plus<int>());
+  hpx::future<int> all_reduced = dist_int.all_reduce(std::plus<int>());
+  hpx::future<int> broadcast = dist_int.broadcast(num_localities - 1);
+
+  if (here == 0) {
+    assert(reduced.get() == sum);
+  }
+  assert(all_reduced.get() == sum);
+  assert(broadcast.get() == num_localities - 1);
+
+  // prefix sums in the order of the localities
+  hpx::future<int> inclusive = dist_int.inclusive_scan(std::plus<int>());
+  hpx::future<int> exclusive = dist_int.exclusive_scan(0, std::plus<int>());
+  assert(inclusive.get() == here * (here + 1) / 2);
+  assert(exclusive.get() == here * (here - 1) / 2);
+
+  // element-wise reduction of vector partitions
+  dist_object<myVectorInt> dist_vec =
+      dist_object<myVectorInt>::create("collectives_vec",
+                                       myVectorInt(len, here))
+          .get();
+  auto max_op = [](int lhs, int rhs) { return (std::max)(lhs, rhs); };
+  myVectorInt max =
+      dist_vec.all_reduce(dist_object::element_wise(max_op)).get();
+  assert(max == myVectorInt(len, num_localities - 1));
+
+  // prefix sums over the elements of all partitions as one sequence
+  myVectorInt inclusive_elements =
+      dist_vec.segmented_inclusive_scan(std::plus<int>()).get();
+  myVectorInt exclusive_elements =
+      dist_vec.segmented_exclusive_scan(0, std::plus<int>()).get();
+  int preceding = len * (here * (here - 1) / 2);
+  for (int j = 0; j < len; j++) {
+    assert(inclusive_elements[j] == preceding + here * (j + 1));
+    assert(exclusive_elements[j] == preceding + here * j);
+  }
+
+  // the partitions of all localities, back to back
+  dist_object::gathered<int> all = dist_vec.all_gather().get();
+  assert(all.size() == num_localities);
+  assert(all.data.size() == len * num_localities);
+  for (int i = 0; i < num_localities; i++) {
+    assert(all.offsets[i] == len * i);
+    assert(all.data[all.offsets[i]] == i);
+  }
+
+  hpx::future<dist_object::gathered<int>> on_root = dist_vec.gather(0);
+  if (here == 0) {
+    assert(on_root.get().data == all.data);
+  }
+
+  // send the gathered data back, each locality receives its own partition
+  myVectorInt own = dist_vec.scatter(0, all).get();
+  assert(own == myVectorInt(len, here));
+
+  // personalized exchange, element i of every partition goes to locality i
+  myVectorInt outgoing(num_localities);
+  for (int i = 0; i < num_localities; i++) {
+    outgoing[i] = here * num_localities + i;
+  }
+  dist_object<myVectorInt> dist_a2a =
+      dist_object<myVectorInt>::create("collectives_a2a", outgoing).get();
+  std::vector<std::size_t> send_offsets(num_localities);
+  std::vector<std::size_t> send_counts(num_localities, 1);
+  for (int i = 0; i < num_localities; i++) {
+    send_offsets[i] = i;
+  }
+  dist_object::gathered<int> incoming =
+      dist_a2a.all_to_all(send_offsets, send_counts).get();
+  for (int i = 0; i < num_localities; i++) {
+    assert(incoming.slice(i) == myVectorInt(1, i * num_localities + here));
+  }
+}
+
+void run_accumulation_remote_atomic() {
+  using dist_object::dist_object;
+  using dist_object::op_type;
+  size_t num_localities = hpx::find_all_localities().size();
+  size_t here = hpx::get_locality_id();
+
+  // a counter and a histogram with one bin per locality, only the ones on
+  // locality 0 are updated
+  dist_object<int> counter("remote_counter", 0);
+  dist_object<myVectorInt> histogram("remote_histogram",
+                                     myVectorInt(num_localities, 0));
+
+  hpx::lcos::barrier wait_for_construction("wait_for_remote_atomic",
+                                           num_localities, here);
+  wait_for_construction.wait();
+
+  // the updates are executed on locality 0, nothing is fetched
+  std::vector<std::size_t> bins(1, here);
+  hpx::wait_all(counter.accumulate(0, static_cast<int>(here)),
+                histogram.accumulate(0, bins, myVectorInt(1, 1)));
+
+  hpx::lcos::barrier wait_for_updates("wait_for_remote_atomic_updates",
+                                      num_localities, here);
+  wait_for_updates.wait();
+
+  if (here == 0) {
+    int target_res = 0;
+    for (int i = 0; i < num_localities; i++) {
+      target_res += i;
+    }
+    assert(*counter == target_res);
+    assert((*histogram) == myVectorInt(num_localities, 1));
+
+    assert(counter.compare_exchange(0, target_res, -1).get() == target_res);
+    assert(counter.fetch_and_op(0, 5, op_type::max).get() == -1);
+    assert(*counter == 5);
+  }
+}
+
 void run_dist_object_vector() {
   // define vector based on the locality that it is running
   int here_ = static_cast<int>(hpx::get_locality_id());
@@ -152,16 +304,19 @@ void run_dist_object_vector() {
   std::vector<int> rhs(len, here_);
   std::vector<int> res(len, 0);
 
-  // construct a dist_object with vector<int> type
-  dist_object::dist_object<std::vector<int>> LHS("lhs_vec", lhs);
-  dist_object::dist_object<std::vector<int>> RHS("rhs_vec", rhs);
-  dist_object::dist_object<std::vector<int>> RES("res_vec", res);
+  // construct the dist_objects with vector<int> type concurrently, each is
+  // ready once all of its partitions are registered
+  typedef dist_object::dist_object<std::vector<int>> dist_vector_type;
+  hpx::future<dist_vector_type> lhs_f =
+      dist_vector_type::create("lhs_vec", lhs);
+  hpx::future<dist_vector_type> rhs_f =
+      dist_vector_type::create("rhs_vec", rhs);
+  hpx::future<dist_vector_type> res_f =
+      dist_vector_type::create("res_vec", res);
 
-  // construct a gobal barrier
-  hpx::lcos::barrier b_dist_vector("b_dist_vector",
-                                   hpx::find_all_localities().size(),
-                                   hpx::get_locality_id());
-  b_dist_vector.wait();
+  dist_vector_type LHS = lhs_f.get();
+  dist_vector_type RHS = rhs_f.get();
+  dist_vector_type RES = res_f.get();
 
   // perform element-wise addition between dist_objects
   for (int i = 0; i < len; i++) {
@@ -176,6 +331,66 @@ void run_dist_object_vector() {
   assert(RES->size() == len);
 }
 
+void run_dist_object_fetch_buffer() {
+  size_t num_localities = hpx::find_all_localities().size();
+  size_t here = hpx::get_locality_id();
+  int len = 10;
+
+  myVectorDouble vec(len);
+  std::iota(vec.begin(), vec.end(), 100.0 * here);
+  dist_object::dist_object<myVectorDouble> dist_vec =
+      dist_object::dist_object<myVectorDouble>::create("fetch_buffer_vec", vec)
+          .get();
+
+  // receive part of the next locality's vector straight into a buffer,
+  // without going through intermediate std::vector copies
+  size_t other = (here + 1) % num_localities;
+  dist_object::dist_object<myVectorDouble>::buffer_type buf =
+      dist_vec.fetch_buffer(other, 2, 5).get();
+  assert(buf.size() == 5);
+  for (size_t i = 0; i != buf.size(); ++i) {
+    assert(buf[i] == 100.0 * other + 2 + i);
+  }
+
+  // receive the same range into memory owned by this locality
+  std::vector<double> recv(5);
+  dist_vec.fetch_into(other, 2, 5, recv.data()).get();
+  for (size_t i = 0; i != recv.size(); ++i) {
+    assert(recv[i] == buf[i]);
+  }
+}
+
+void run_dist_object_put() {
+  size_t num_localities = hpx::find_all_localities().size();
+  size_t here = hpx::get_locality_id();
+  int len = 10;
+
+  dist_object::dist_object<myVectorDouble> dist_vec("put_vec",
+                                                    myVectorDouble(len, -1.0));
+
+  hpx::lcos::barrier b_put("b_put", num_localities, here);
+  b_put.wait();
+
+  // every locality pushes into the first half of the next locality's vector
+  // and overwrites the whole vector of locality 0 with its own id
+  size_t other = (here + 1) % num_localities;
+  std::vector<double> tile(len / 2, static_cast<double>(here));
+  dist_vec.put(other, 0, tile.data(), tile.size()).get();
+  if (here == num_localities - 1) {
+    dist_vec.put(0, myVectorDouble(len, 42.0)).get();
+  }
+
+  hpx::lcos::barrier b_put_done("b_put_done", num_localities, here);
+  b_put_done.wait();
+
+  if (here == 0) {
+    assert((*dist_vec) == myVectorDouble(len, 42.0));
+  } else {
+    double from = static_cast<double>(here - 1);
+    assert((*dist_vec)[0] == from && (*dist_vec)[len - 1] == -1.0);
+  }
+}
+
 // element-wise addition for vector<vector<double>> for dist_object
 void run_dist_object_matrix() {
   double val = 42.0 + static_cast<double>(hpx::get_locality_id());
@@ -211,6 +426,12 @@ void run_dist_object_matrix() {
       hpx::future<myMatrixDouble> RES_first = RES.fetch(0);
       assert(RES_first.get()[0][0] == 84);
     }
+
+    // fetch only the last two rows of the remote partition
+    size_t other = (hpx::get_locality_id() + 1) % 2;
+    myMatrixDouble RES_rows = RES.fetch(other, rows - 2, 2).get();
+    assert(RES_rows.size() == 2);
+    assert(RES_rows[1][cols - 1] == 2 * (42.0 + other));
   }
 }
 
@@ -291,6 +512,272 @@ void run_dist_object_matrix_mo() {
   assert(M3->size() == rows);
 }
 
+void run_dist_object_matrix_tree() {
+  int val = 42 + static_cast<int>(hpx::get_locality_id());
+  int rows = 5, cols = 5;
+
+  myMatrixInt m1(rows, std::vector<int>(cols, val));
+
+  typedef dist_object::construction_type c_t;
+
+  // all ids are known once the constructor returns, no barrier needed
+  dist_object::dist_object<myMatrixInt, c_t::Tree> M1("M1_tree", m1);
+  hpx::future<void> resolved = M1.resolve_all();
+  assert(resolved.is_ready());
+
+  std::size_t num_locs = hpx::find_all_localities().size();
+  std::size_t next = (hpx::get_locality_id() + 1) % num_locs;
+  hpx::future<myMatrixInt> k = M1.fetch(static_cast<int>(next));
+  assert(k.get()[0][0] == 42 + static_cast<int>(next));
+}
+
+// Number of rows of the locality grid closest to square
+size_t square_grid_rows(size_t num_locs) {
+  size_t grid_rows = 1;
+  for (size_t r = 1; r * r <= num_locs; r++) {
+    if (num_locs % r == 0) {
+      grid_rows = r;
+    }
+  }
+  return grid_rows;
+}
+
+// Every locality fills its tiles with the global indices of the elements,
+// then checks all tiles, most of which are fetched from other localities
+template <typename Layout> void run_dist_matrix(std::string const &base) {
+  size_t num_locs = hpx::find_all_localities().size();
+  size_t here = hpx::get_locality_id();
+  size_t rows = 10, cols = 7;
+
+  size_t grid_rows = square_grid_rows(num_locs);
+  dist_object::dist_matrix<double, Layout> M(base, rows, cols, 3, 2, grid_rows,
+                                             num_locs / grid_rows);
+
+  for (size_t I = 0; I < M.num_tile_rows(); I++) {
+    for (size_t J = 0; J < M.num_tile_cols(); J++) {
+      if (!M.is_local(I, J)) {
+        continue;
+      }
+      auto &t = M.local_tile(I, J);
+      for (size_t i = 0; i < t.rows(); i++) {
+        for (size_t j = 0; j < t.cols(); j++) {
+          t(i, j) = (M.first_row_of(I) + i) * cols + M.first_col_of(J) + j;
+        }
+      }
+    }
+  }
+
+  hpx::lcos::barrier wait_for_fill(base + "_barrier", num_locs, here);
+  wait_for_fill.wait();
+
+  for (size_t I = 0; I < M.num_tile_rows(); I++) {
+    for (size_t J = 0; J < M.num_tile_cols(); J++) {
+      auto t = M.fetch_tile(I, J).get();
+      assert(t.rows() == M.tile_rows_of(I) && t.cols() == M.tile_cols_of(J));
+      for (size_t i = 0; i < t.rows(); i++) {
+        for (size_t j = 0; j < t.cols(); j++) {
+          assert(t(i, j) ==
+                 (M.first_row_of(I) + i) * cols + M.first_col_of(J) + j);
+        }
+      }
+    }
+  }
+}
+
+// Every element is owned by exactly one locality, and local_index and
+// global_index are inverse to each other
+void check_distribution(dist_object::distribution const &d) {
+  std::vector<size_t> counts(d.num_localities(), 0);
+  for (size_t i = 0; i < d.size(); i++) {
+    size_t loc = d.owner(i);
+    assert(loc < d.num_localities());
+    assert(d.local_index(i) < d.local_size(loc));
+    assert(d.global_index(loc, d.local_index(i)) == i);
+    counts[loc]++;
+  }
+  for (size_t loc = 0; loc < d.num_localities(); loc++) {
+    assert(counts[loc] == d.local_size(loc));
+  }
+}
+
+void run_dist_vector() {
+  using dist_object::distribution;
+
+  // 10 elements over 3 localities, the last block is cut short
+  distribution block = distribution::block().bind(10, 3);
+  assert(block.block_size() == 4);
+  assert(block.owner(3) == 0 && block.owner(4) == 1 && block.owner(9) == 2);
+  assert(block.local_index(9) == 1 && block.global_index(1, 2) == 6);
+  assert(block.local_size(0) == 4 && block.local_size(2) == 2);
+
+  distribution cyclic = distribution::cyclic().bind(10, 3);
+  assert(cyclic.owner(7) == 1 && cyclic.local_index(7) == 2);
+  assert(cyclic.global_index(2, 1) == 5);
+  assert(cyclic.local_size(0) == 4 && cyclic.local_size(2) == 3);
+
+  distribution block_cyclic = distribution::block_cyclic(3).bind(10, 3);
+  assert(block_cyclic.owner(9) == 0 && block_cyclic.local_index(9) == 3);
+  assert(block_cyclic.owner(5) == 1 && block_cyclic.local_index(5) == 2);
+  assert(block_cyclic.global_index(2, 2) == 8);
+  assert(block_cyclic.local_size(0) == 4 && block_cyclic.local_size(1) == 3);
+
+  for (size_t num_locs : {1, 2, 3, 7}) {
+    for (size_t size : {0, 1, 10, 23}) {
+      check_distribution(distribution::block().bind(size, num_locs));
+      check_distribution(distribution::cyclic().bind(size, num_locs));
+      check_distribution(distribution::block_cyclic(3).bind(size, num_locs));
+    }
+    distribution empty = distribution::block().bind(0, num_locs);
+    for (size_t loc = 0; loc < num_locs; loc++) {
+      assert(empty.num_blocks(loc) == 0 && empty.local_size(loc) == 0);
+    }
+  }
+
+  // Each locality fills its elements through the segments, then reads and
+  // overwrites the ones of the next locality
+  size_t num_locs = hpx::find_all_localities().size();
+  size_t here = hpx::get_locality_id();
+  size_t next = (here + 1) % num_locs;
+  size_t n = 10 * num_locs + 3;
+  dist_object::dist_vector<double> v("dist_vector", n,
+                                     distribution::block_cyclic(3));
+  auto value = [](size_t i) { return double(i * i); };
+
+  using hpx::parallel::execution::par;
+  for (auto &seg : v.segments()) {
+    double *first = seg.begin();
+    hpx::parallel::for_each(par, seg.begin(), seg.end(), [&](double &e) {
+      e = value(seg.first() + (&e - first));
+    });
+  }
+
+  hpx::lcos::barrier wait_for_fill("dist_vector_fill", num_locs, here);
+  wait_for_fill.wait();
+
+  std::vector<hpx::future<void>> writes;
+  for (size_t i = 0; i < n; i++) {
+    if (v.get_distribution().owner(i) == next) {
+      assert(v[i].get() == value(i));
+      writes.push_back(v.set(i, -value(i)));
+    }
+  }
+  hpx::wait_all(writes);
+
+  hpx::lcos::barrier wait_for_set("dist_vector_set", num_locs, here);
+  wait_for_set.wait();
+
+  // the local sum runs on the segments only
+  double sum = 0.0;
+  for (auto &seg : v.segments()) {
+    sum += hpx::parallel::transform_reduce(
+        par, seg.begin(), seg.end(), 0.0,
+        [](double lhs, double rhs) { return lhs + rhs; },
+        [](double e) { return e; });
+  }
+  double expected = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    if (v.is_local(i)) {
+      expected -= value(i);
+    }
+  }
+  assert(sum == expected);
+}
+
+void run_dist_unordered_map() {
+  int num_localities = static_cast<int>(hpx::find_all_localities().size());
+  int here = static_cast<int>(hpx::get_locality_id());
+  int num_keys = 100;
+
+  dist_object::dist_unordered_map<int, double> map("dist_unordered_map");
+
+  // every locality inserts its own range of keys in one batch
+  std::vector<int> keys(num_keys);
+  std::vector<double> values(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    keys[i] = here * num_keys + i;
+    values[i] = 0.5 * keys[i];
+  }
+  assert(map.multi_insert(keys, values).get() == num_keys);
+  assert(!map.insert(keys[0], -1.0).get());
+  assert(map.update(keys[0], values[0]).get());
+
+  hpx::lcos::barrier wait_for_inserts("dist_unordered_map_barrier",
+                                      num_localities, here);
+  wait_for_inserts.wait();
+
+  // look up the keys of all localities, plus one which is missing
+  std::vector<int> all_keys(num_keys * num_localities + 1);
+  std::iota(all_keys.begin(), all_keys.end(), 0);
+  std::vector<dist_object::find_result<double>> found =
+      map.multi_find(all_keys).get();
+  for (int k = 0; k < num_keys * num_localities; k++) {
+    assert(found[k].found && found[k].value == 0.5 * k);
+  }
+  assert(!found.back().found);
+  assert(map.find(all_keys.back()).get().found == false);
+  assert(map.size().get() == num_keys * num_localities);
+}
+
+// Sparse matrix-vector products with the 1D Laplacian, each locality only
+// needs the entries of x next to its block of rows from its neighbors
+void run_dist_csr_matrix() {
+  size_t num_locs = hpx::find_all_localities().size();
+  size_t here = hpx::get_locality_id();
+  size_t n = 10 * num_locs - 1; // the last locality owns one row less
+
+  // the rows and x are distributed in blocks, the rows of a locality are
+  // the entries of x it owns
+  dist_object::distribution rows =
+      dist_object::distribution::block().bind(n, num_locs);
+  std::vector<size_t> row_offsets(num_locs + 1, 0);
+  for (size_t loc = 0; loc < num_locs; loc++) {
+    row_offsets[loc + 1] = row_offsets[loc] + rows.local_size(loc);
+  }
+
+  std::vector<size_t> row_ptr(1, 0);
+  std::vector<size_t> cols;
+  std::vector<double> values;
+  for (size_t i = row_offsets[here]; i < row_offsets[here + 1]; i++) {
+    if (i > 0) {
+      cols.push_back(i - 1);
+      values.push_back(-1.0);
+    }
+    cols.push_back(i);
+    values.push_back(2.0);
+    if (i + 1 < n) {
+      cols.push_back(i + 1);
+      values.push_back(-1.0);
+    }
+    row_ptr.push_back(cols.size());
+  }
+
+  dist_object::dist_csr_matrix<double> A("csr_laplacian", row_offsets,
+                                         row_ptr, cols, values);
+  assert(A.num_ghosts() == (here > 0) + (here + 1 < num_locs));
+
+  dist_object::dist_vector<double> x("csr_x", n);
+  assert(x.get_distribution().local_size(here) ==
+         row_offsets[here + 1] - row_offsets[here]);
+
+  // the communication plan is reused by every product
+  for (int iteration = 1; iteration <= 2; iteration++) {
+    auto x_at = [iteration](size_t i) { return double(iteration * i * i); };
+    for (auto &seg : x.segments()) {
+      for (size_t r = 0; r < seg.size(); r++) {
+        seg.begin()[r] = x_at(seg.first() + r);
+      }
+    }
+
+    std::vector<double> y = A.multiply(x.partition()).get();
+    for (size_t r = 0; r < y.size(); r++) {
+      size_t i = row_offsets[here] + r;
+      double expected = 2.0 * x_at(i) - (i > 0 ? x_at(i - 1) : 0.0) -
+                        (i + 1 < n ? x_at(i + 1) : 0.0);
+      assert(y[r] == expected);
+    }
+  }
+}
+
 void run_dist_object_ref() {
   size_t n = 10;
   int val = 2;
@@ -371,117 +858,71 @@ void run_dist_object_matrix_mo_loc_list(std::vector<size_t> locs)
 }
 
 
+// C = A * B with SUMMA over the grid closest to square. The elements are
+// small integers, so the result can be checked exactly against a product
+// computed from the same formulas
 void run_dist_object_matrix_mul() {
-  int cols = 5; // Decide how big the matrix should be
-
   size_t num_locs = hpx::find_all_localities().size();
-  std::vector<std::pair<size_t, size_t>> ranges(num_locs);
-
-  // Create a list of row ranges for each partition
-  size_t start = 0;
-  size_t diff = (int)std::ceil((double)cols / ((double)num_locs));
-  for (int i = 0; i < num_locs; i++) {
-    size_t second = min(cols, start + diff);
-    ranges[i] = std::make_pair(start, second);
-    start += diff;
-  }
-
-  // Create our data, stored in all_data's. This way we can check for validity
-  // without using anything distributed. The seed being a constant is needed
-  // in order for all nodes to generate the same data
   size_t here = hpx::get_locality_id();
-  size_t local_rows = ranges[here].second - ranges[here].first;
-  std::vector<std::vector<std::vector<int>>> all_data_m1(
-      hpx::find_all_localities().size());
-
-  std::srand(123456);
-
-  for (int i = 0; i < all_data_m1.size(); i++) {
-    size_t tmp_num_rows = ranges[i].second - ranges[i].first;
-    all_data_m1[i] =
-        std::vector<std::vector<int>>(tmp_num_rows, std::vector<int>(cols, 0));
-    for (int j = 0; j < tmp_num_rows; j++) {
-      for (int k = 0; k < cols; k++) {
-        all_data_m1[i][j][k] = std::rand();
+  size_t m = 37, k = 23, n = 29; // ragged tiles on purpose
+  size_t grid_rows = square_grid_rows(num_locs);
+  size_t grid_cols = num_locs / grid_rows;
+
+  auto a = [](size_t i, size_t l) { return double((i + 2 * l) % 7); };
+  auto b = [](size_t l, size_t j) { return double((3 * l + j) % 5); };
+
+  typedef dist_object::dist_matrix<double, dist_object::row_major> matrix;
+  matrix A("A_mat_mul", m, k, 8, 5, grid_rows, grid_cols);
+  matrix B("B_mat_mul", k, n, 5, 7, grid_rows, grid_cols);
+  matrix C("C_mat_mul", m, n, 8, 7, grid_rows, grid_cols);
+
+  for (size_t I = 0; I < A.num_tile_rows(); I++) {
+    for (size_t J = 0; J < A.num_tile_cols(); J++) {
+      if (A.is_local(I, J)) {
+        auto &t = A.local_tile(I, J);
+        for (size_t i = 0; i < t.rows(); i++)
+          for (size_t j = 0; j < t.cols(); j++)
+            t(i, j) = a(A.first_row_of(I) + i, A.first_col_of(J) + j);
       }
     }
   }
-
-  std::vector<std::vector<std::vector<int>>> all_data_m2(
-      hpx::find_all_localities().size());
-
-  std::srand(7891011);
-
-  for (int i = 0; i < all_data_m2.size(); i++) {
-    size_t tmp_num_rows = ranges[i].second - ranges[i].first;
-    all_data_m2[i] =
-        std::vector<std::vector<int>>(tmp_num_rows, std::vector<int>(cols, 0));
-    for (int j = 0; j < tmp_num_rows; j++) {
-      for (int k = 0; k < cols; k++) {
-        all_data_m2[i][j][k] = std::rand();
+  for (size_t I = 0; I < B.num_tile_rows(); I++) {
+    for (size_t J = 0; J < B.num_tile_cols(); J++) {
+      if (B.is_local(I, J)) {
+        auto &t = B.local_tile(I, J);
+        for (size_t i = 0; i < t.rows(); i++)
+          for (size_t j = 0; j < t.cols(); j++)
+            t(i, j) = b(B.first_row_of(I) + i, B.first_col_of(J) + j);
       }
     }
   }
 
-  std::vector<std::vector<int>> here_data_m3(local_rows,
-                                             std::vector<int>(cols, 0));
+  hpx::lcos::barrier wait_for_fill("mat_mul_fill", num_locs, here);
+  wait_for_fill.wait();
 
-  typedef dist_object::construction_type c_t;
+  dist_object::summa(C, A, B);
 
-  dist_object::dist_object<myMatrixInt, c_t::Meta_Object> M1("M1_meta_mat_mul",
-	  all_data_m1[here]);
-  dist_object::dist_object<myMatrixInt, c_t::Meta_Object> M2("M2_meta_mat_mul",
-	  all_data_m2[here]);
-  dist_object::dist_object<myMatrixInt, c_t::Meta_Object> M3("M3_meta_mat_mul",
-	  here_data_m3);
-
-  // Actual matrix multiplication. For non-local values, get the data
-  // and then use it, for local, just use the local data without doing
-  // a fetch to get it
-  size_t num_before_me = here;
-  size_t num_after_me = hpx::find_all_localities().size() - 1 - here;
-  int other_val;
-  for (int p = 0; p < num_before_me; p++) {
-    std::vector<std::vector<int>> non_local = M2.fetch(p).get();
-    std::size_t non_local_rows = ranges[p].second - ranges[p].first;
-    if (p == 0)
-      other_val = non_local[0][0];
-    for (int i = 0; i < local_rows; i++) {
-      for (int j = ranges[p].first; j < ranges[p].second; j++) {
-        for (int k = 0; k < cols; k++) {
-          (*M3)[i][j] += (*M1)[i][k] * non_local[j - ranges[p].first][k];
-          here_data_m3[i][j] +=
-              all_data_m1[here][i][k] * all_data_m2[p][j - ranges[p].first][k];
-        }
-      }
-    }
-  }
-  for (int i = 0; i < local_rows; i++) {
-    for (int j = ranges[here].first; j < ranges[here].second; j++) {
-      for (int k = 0; k < cols; k++) {
-        (*M3)[i][j] += (*M1)[i][k] * (*M2)[j - ranges[here].first][k];
-        here_data_m3[i][j] += all_data_m1[here][i][k] *
-                              all_data_m2[here][j - ranges[here].first][k];
+  // no locality may leave before the others fetched its tiles
+  hpx::lcos::barrier wait_for_summa("mat_mul_summa", num_locs, here);
+  wait_for_summa.wait();
+
+  for (size_t I = 0; I < C.num_tile_rows(); I++) {
+    for (size_t J = 0; J < C.num_tile_cols(); J++) {
+      if (!C.is_local(I, J)) {
+        continue;
       }
-    }
-  }
-  for (int p = here + 1; p < num_locs; p++) {
-    std::vector<std::vector<int>> non_local = M2.fetch(p).get();
-    std::size_t non_local_rows = ranges[p].second - ranges[p].first;
-    if (p == here + 1)
-      other_val = non_local[0][0];
-    for (int i = 0; i < local_rows; i++) {
-      for (int j = ranges[p].first; j < ranges[p].second; j++) {
-        for (int k = 0; k < cols; k++) {
-          (*M3)[i][j] += (*M1)[i][k] * non_local[j - ranges[p].first][k];
-          here_data_m3[i][j] +=
-              all_data_m1[here][i][k] * all_data_m2[p][j - ranges[p].first][k];
+      auto const &t = C.local_tile(I, J);
+      for (size_t i = 0; i < t.rows(); i++) {
+        for (size_t j = 0; j < t.cols(); j++) {
+          size_t gi = C.first_row_of(I) + i, gj = C.first_col_of(J) + j;
+          double expected = 0;
+          for (size_t l = 0; l < k; l++)
+            expected += a(gi, l) * b(l, gj);
+          assert(t(i, j) == expected);
         }
       }
     }
   }
-  std::vector<std::vector<int>> tmp = *M3;
-  assert((*M3) == here_data_m3);
 }
 
 int hpx_main() {
@@ -490,10 +931,20 @@ int hpx_main() {
   run_dist_object_int();
   run_accumulation_reduce_to_locality0_parallel();
   run_accumulation_reduce_to_locality0();
+  run_accumulation_remote_atomic();
+  run_collectives();
   run_dist_object_vector();
+  run_dist_object_fetch_buffer();
+  run_dist_object_put();
   run_dist_object_matrix();
   run_dist_object_matrix_all_to_all();
   run_dist_object_matrix_mo();
+  run_dist_object_matrix_tree();
+  run_dist_matrix<dist_object::row_major>("dist_matrix_row");
+  run_dist_matrix<dist_object::column_major>("dist_matrix_col");
+  run_dist_vector();
+  run_dist_unordered_map();
+  run_dist_csr_matrix();
   run_dist_object_matrix_mul();
   run_dist_object_ref();
   run_dist_object_const_ref();
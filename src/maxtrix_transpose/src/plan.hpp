@@ -0,0 +1,198 @@
+//  Copyright (c) 2019 Weile Wei
+//  Copyright (c) 2019 Maxwell Reesser
+//  Copyright (c) 2019 Hartmut Kaiser
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#if !defined(HPX_DIST_OBJECT_PLAN_OCT_16_2019_0700PM)
+#define HPX_DIST_OBJECT_PLAN_OCT_16_2019_0700PM
+
+#include <hpx/include/lcos.hpp>
+#include <hpx/util/assert.hpp>
+
+#include "template_dist_object.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// A plan records a fixed set of reads from and writes to the partitions of
+// a dist_object_array once, for codes which repeat the same exchange in
+// every iteration. commit resolves the ids of all partitions involved, after
+// that execute issues the recorded actions directly, without any lookups,
+// offset computations or allocations. Reads are deserialized straight into
+// their destination (see dist_object::fetch_into), which is typically a
+// receive buffer allocated by the plan, so its address never changes.
+// These buffers are only pre-allocated, they are not pinned or registered
+// with the parcel layer: the TCP parcelport has no notion of registered
+// memory and copies through its own socket buffers, so a stable address to
+// deserialize into is all a repeated exchange can reuse.
+// Operations on partitions of this locality are plain copies. The array and
+// all memory recorded in the plan have to outlive it.
+namespace dist_object {
+	template <typename T, typename Policy = shared_read_policy>
+	class plan {
+		typedef dist_object_array<T, Policy> array_type;
+		typedef server::partition<T, Policy> server_type;
+		typedef typename server_type::buffer_type buffer_type;
+		typedef typename server_type::pointer_buffer_type
+			pointer_buffer_type;
+
+		struct operation {
+			bool read;
+			std::size_t loc;
+			std::size_t part;
+			std::size_t offset;
+			std::size_t count;
+			T* data;
+			hpx::id_type id;
+		};
+
+	public:
+		plan() {}
+
+		explicit plan(array_type& array)
+			: array_(&array),
+			  ops_(std::make_shared<std::vector<operation>>())
+		{}
+
+		// The operations refer to the receive buffers of this instance
+		plan(plan const&) = delete;
+		plan(plan&&) = default;
+		plan& operator=(plan const&) = delete;
+		plan& operator=(plan&&) = default;
+
+		// Number of recorded operations
+		std::size_t size() const
+		{
+			return ops_->size();
+		}
+
+		// Receive buffer of count elements owned by the plan, allocated once
+		// and kept at the same address (not pinned, see above)
+		T* allocate(std::size_t count)
+		{
+			buffers_.push_back(std::vector<T>(count));
+			return buffers_.back().data();
+		}
+
+		// Records reading the elements [offset, offset + count) of the
+		// partition i of locality loc into dest, returns the index of the
+		// operation
+		std::size_t read(std::size_t loc, std::size_t i, std::size_t offset,
+			std::size_t count, T* dest)
+		{
+			return record(true, loc, i, offset, count, dest);
+		}
+
+		// Records overwriting the elements [offset, offset + count) of the
+		// partition i of locality loc with the ones at data
+		std::size_t write(std::size_t loc, std::size_t i, std::size_t offset,
+			T const* data, std::size_t count)
+		{
+			return record(false, loc, i, offset, count, const_cast<T*>(data));
+		}
+
+		// Resolves the ids of the partitions addressed by the operations
+		// recorded so far, has to be ready before they are executed or
+		// further ones are recorded
+		hpx::future<void> commit()
+		{
+			std::vector<hpx::future<void>> resolved;
+			std::shared_ptr<std::vector<operation>> ops = ops_;
+			for (std::size_t op = 0; op != ops->size(); ++op) {
+				if ((*ops)[op].id || is_local((*ops)[op]))
+					continue;
+
+				resolved.push_back(array_->part_id((*ops)[op].loc,
+					(*ops)[op].part).then(hpx::launch::sync,
+					[ops, op](hpx::future<hpx::id_type> f)
+					{
+						(*ops)[op].id = f.get();
+					}));
+			}
+
+			return hpx::when_all(resolved).then(hpx::launch::sync,
+				[](hpx::future<std::vector<hpx::future<void>>> f)
+				{
+					// rethrow any failed lookup
+					for (hpx::future<void>& r : f.get())
+						r.get();
+				});
+		}
+
+		// Issues the operation op, the future becomes ready once it is
+		// complete
+		hpx::future<void> execute(std::size_t op)
+		{
+			HPX_ASSERT(op < ops_->size());
+			operation const& o = (*ops_)[op];
+			if (is_local(o)) {
+				T* part = array_->local(o.part).data() + o.offset;
+				if (o.read)
+					std::copy(part, part + o.count, o.data);
+				else
+					std::copy(o.data, o.data + o.count, part);
+				return hpx::make_ready_future();
+			}
+
+			HPX_ASSERT(o.id);
+			if (!o.read) {
+				typedef typename server_type::put_buffer_action action_type;
+				return hpx::async<action_type>(o.id, o.offset,
+					buffer_type(o.data, o.count, buffer_type::reference));
+			}
+
+			typedef typename server_type::fetch_pointer_action action_type;
+			T* dest = o.data;
+			return hpx::async<action_type>(o.id, o.offset, o.count,
+				reinterpret_cast<std::size_t>(dest)).then(hpx::launch::sync,
+				[dest](hpx::future<pointer_buffer_type> f)
+				{
+					pointer_buffer_type buffer = f.get();
+					if (buffer.data() != dest)
+						std::copy(buffer.data(), buffer.data() + buffer.size(),
+							dest);
+				});
+		}
+
+		// Issues all operations at once
+		hpx::future<void> execute()
+		{
+			std::vector<hpx::future<void>> done;
+			done.reserve(ops_->size());
+			for (std::size_t op = 0; op != ops_->size(); ++op)
+				done.push_back(execute(op));
+
+			return hpx::when_all(done).then(hpx::launch::sync,
+				[](hpx::future<std::vector<hpx::future<void>>> f)
+				{
+					for (hpx::future<void>& d : f.get())
+						d.get();
+				});
+		}
+
+	private:
+		std::size_t record(bool read, std::size_t loc, std::size_t i,
+			std::size_t offset, std::size_t count, T* data)
+		{
+			HPX_ASSERT(array_);
+			ops_->push_back(
+				operation{read, loc, i, offset, count, data, hpx::id_type()});
+			return ops_->size() - 1;
+		}
+
+		bool is_local(operation const& o) const
+		{
+			return o.loc == hpx::get_locality_id();
+		}
+
+		array_type* array_ = nullptr;
+		std::shared_ptr<std::vector<operation>> ops_;
+		std::vector<std::vector<T>> buffers_;
+	};
+}
+#endif
@@ -10,24 +10,189 @@
 
 #include <hpx/include/actions.hpp>
 #include <hpx/include/components.hpp>
+#include <hpx/lcos/local/mutex.hpp>
+#include <hpx/lcos/local/promise.hpp>
+#include <hpx/lcos/local/shared_mutex.hpp>
+#include <hpx/lcos/local/spinlock.hpp>
+#include <hpx/runtime/serialization/serialize.hpp>
+#include <hpx/runtime/serialization/serialize_buffer.hpp>
+#include <hpx/runtime/serialization/vector.hpp>
+#include <hpx/util/assert.hpp>
 #include <hpx/util/detail/pp/cat.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+// Concurrency policies of the partition server, selecting how actions running
+// concurrently on the same partition are synchronized
+namespace dist_object {
+	// Actions only reading the data (fetch and friends) run concurrently,
+	// actions modifying it are exclusive. This is the default.
+	struct shared_read_policy
+	{
+		typedef hpx::lcos::local::shared_mutex mutex_type;
+		typedef std::shared_lock<mutex_type> read_lock;
+		typedef std::unique_lock<mutex_type> write_lock;
+	};
+
+	// Every action is exclusive, as with hpx::components::locking_hook
+	struct exclusive_policy
+	{
+		typedef hpx::lcos::local::mutex mutex_type;
+		typedef std::unique_lock<mutex_type> read_lock;
+		typedef std::unique_lock<mutex_type> write_lock;
+	};
+
+	// No synchronization at all, for callers ordering reads and writes by
+	// other means (e.g. barriers)
+	struct unsynchronized_policy
+	{
+		struct mutex_type {};
+		struct read_lock
+		{
+			explicit read_lock(mutex_type&) {}
+		};
+		typedef read_lock write_lock;
+	};
+}
+
 namespace dist_object {
 	namespace server {
-		template <typename T>
-		class partition : public hpx::components::locking_hook<
-			hpx::components::component_base<partition<T>>> {
+		namespace detail {
+			// Allocator handing out a single chunk of memory provided by the
+			// caller. Its address travels with the allocator when being
+			// serialized, which allows a serialize_buffer to be deserialized
+			// straight into memory the requesting locality already owns.
+			template <typename T>
+			class pointer_allocator {
+			public:
+				typedef T value_type;
+				typedef T* pointer;
+				typedef T const* const_pointer;
+				typedef std::size_t size_type;
+				typedef std::ptrdiff_t difference_type;
+
+				template <typename U>
+				struct rebind { typedef pointer_allocator<U> other; };
+
+				pointer_allocator() noexcept : pointer_(nullptr), size_(0) {}
+
+				pointer_allocator(pointer p, size_type size) noexcept
+					: pointer_(p), size_(size) {}
+
+				pointer allocate(size_type n, void const* = nullptr)
+				{
+					HPX_ASSERT(n == size_);
+					return pointer_;
+				}
+
+				void deallocate(pointer p, size_type n)
+				{
+					HPX_ASSERT(p == pointer_ && n == size_);
+				}
+
+			private:
+				friend class hpx::serialization::access;
+
+				template <typename Archive>
+				void load(Archive& ar, unsigned int const)
+				{
+					std::size_t address = 0;
+					ar >> size_ >> address;
+					pointer_ = reinterpret_cast<pointer>(address);
+				}
+
+				template <typename Archive>
+				void save(Archive& ar, unsigned int const) const
+				{
+					std::size_t address = reinterpret_cast<std::size_t>(pointer_);
+					ar << size_ << address;
+				}
+
+				HPX_SERIALIZATION_SPLIT_MEMBER()
+
+				pointer pointer_;
+				size_type size_;
+			};
+
+			// Matches values deposited by other localities with the local
+			// receive of the same tag, in whichever order the two arrive
+			template <typename Value>
+			class mailbox {
+				struct slot {
+					slot() : matched(false) {}
+
+					hpx::lcos::local::promise<Value> promise;
+					bool matched;
+				};
+
+			public:
+				hpx::future<Value> receive(std::uint64_t tag)
+				{
+					std::lock_guard<hpx::lcos::local::spinlock> l(mtx_);
+					slot& s = slots_[tag];
+					hpx::future<Value> f = s.promise.get_future();
+					if (s.matched)
+						slots_.erase(tag);
+					else
+						s.matched = true;
+					return f;
+				}
+
+				void deposit(std::uint64_t tag, Value value)
+				{
+					hpx::lcos::local::promise<Value> p;
+					{
+						std::lock_guard<hpx::lcos::local::spinlock> l(mtx_);
+						slot& s = slots_[tag];
+						if (!s.matched) {
+							// nobody waits yet, no continuation runs under
+							// the lock
+							s.matched = true;
+							s.promise.set_value(std::move(value));
+							return;
+						}
+						p = std::move(s.promise);
+						slots_.erase(tag);
+					}
+					p.set_value(std::move(value));
+				}
+
+			private:
+				hpx::lcos::local::spinlock mtx_;
+				std::unordered_map<std::uint64_t, slot> slots_;
+			};
+		}
+
+		template <typename T, typename Policy = shared_read_policy>
+		class partition
+			: public hpx::components::component_base<partition<T, Policy>> {
+			typedef typename Policy::read_lock read_lock;
+			typedef typename Policy::write_lock write_lock;
+
 		public:
 			typedef std::vector<T> data_type;
+			typedef hpx::serialization::serialize_buffer<T> buffer_type;
+			typedef hpx::serialization::serialize_buffer<T,
+				detail::pointer_allocator<T>> pointer_buffer_type;
+
 			partition() {}
 
 			partition(data_type const &data) : data_(data) {}
 
 			partition(data_type &&data) : data_(std::move(data)) {}
 
-			size_t size() { return data_.size(); }
+			size_t size()
+			{
+				read_lock l(mtx_);
+				return data_.size();
+			}
 
 			data_type &operator*() { return data_; }
 
@@ -45,37 +210,198 @@ namespace dist_object {
 
 			data_type fetch() const
 			{
+				read_lock l(mtx_);
 				return data_;
 			}
 
+			// Returns only the elements [offset, offset + count), so that
+			// remote callers pay just for the slice they actually use
+			data_type fetch_range(std::size_t offset, std::size_t count) const
+			{
+				read_lock l(mtx_);
+				HPX_ASSERT(offset + count <= data_.size());
+				return data_type(data_.begin() + offset,
+					data_.begin() + offset + count);
+			}
+
+			// Zero-copy variant of fetch_range for trivially copyable T. The
+			// returned buffer references the local data, which is serialized
+			// straight out of the partition's storage after the action has
+			// returned, so the range must not be modified while the fetch is
+			// in flight
+			buffer_type fetch_buffer(std::size_t offset, std::size_t count) const
+			{
+				read_lock l(mtx_);
+				HPX_ASSERT(offset + count <= data_.size());
+				return buffer_type(const_cast<T*>(data_.data()) + offset,
+					count, buffer_type::reference);
+			}
+
+			// Backs dist_object::fetch_into: dest is the address of the
+			// caller's destination memory, the returned buffer is
+			// deserialized directly into it
+			pointer_buffer_type fetch_pointer(std::size_t offset,
+				std::size_t count, std::size_t dest) const
+			{
+				read_lock l(mtx_);
+				HPX_ASSERT(offset + count <= data_.size());
+				detail::pointer_allocator<T> alloc(
+					reinterpret_cast<T*>(dest), count);
+				return pointer_buffer_type(const_cast<T*>(data_.data()) + offset,
+					count, pointer_buffer_type::reference, alloc);
+			}
+
+			void put(data_type const& value)
+			{
+				write_lock l(mtx_);
+				data_ = value;
+			}
+
+			// Overwrites the elements [offset, offset + values.size())
+			void put_buffer(std::size_t offset, buffer_type const& values)
+			{
+				write_lock l(mtx_);
+				HPX_ASSERT(offset + values.size() <= data_.size());
+				std::copy(values.data(), values.data() + values.size(),
+					data_.data() + offset);
+			}
+
+			// Point-to-point transfer backing dist_object::all_to_all, the
+			// elements are handed to the local receive of the same tag and
+			// do not touch the data of this partition
+			void deposit(std::uint64_t tag, buffer_type const& values)
+			{
+				mailbox_.deposit(tag, values);
+			}
+
+			hpx::future<buffer_type> receive(std::uint64_t tag)
+			{
+				return mailbox_.receive(tag);
+			}
+
 			HPX_DEFINE_COMPONENT_ACTION(partition, size);
 			HPX_DEFINE_COMPONENT_ACTION(partition, fetch);
+			HPX_DEFINE_COMPONENT_ACTION(partition, fetch_range);
+			HPX_DEFINE_COMPONENT_ACTION(partition, fetch_buffer);
+			HPX_DEFINE_COMPONENT_ACTION(partition, fetch_pointer);
+			HPX_DEFINE_COMPONENT_ACTION(partition, put);
+			HPX_DEFINE_COMPONENT_ACTION(partition, put_buffer);
+			HPX_DEFINE_COMPONENT_ACTION(partition, deposit);
 
 		private:
+			mutable typename Policy::mutex_type mtx_;
 			data_type data_;
+			detail::mailbox<buffer_type> mailbox_;
 		};
 	}
 }
 
+// The part_directory lists the partitions a dist_object_array created on one
+// locality. It is the only thing registered with AGAS for them, remote
+// localities get the ids of all those partitions with a single request.
+namespace dist_object {
+	namespace server {
+		class part_directory
+			: public hpx::components::component_base<part_directory> {
+		public:
+			part_directory() {}
+
+			explicit part_directory(std::vector<hpx::id_type> const& parts)
+				: parts_(parts) {}
+
+			std::vector<hpx::id_type> get_parts() const
+			{
+				return parts_;
+			}
+
+			HPX_DEFINE_COMPONENT_ACTION(part_directory, get_parts);
+
+		private:
+			std::vector<hpx::id_type> parts_;
+		};
+	}
+}
+
+HPX_REGISTER_ACTION_DECLARATION(
+	dist_object::server::part_directory::get_parts_action,
+	part_directory_get_parts_action);
+
+// REGISTER_PARTITION registers partition<type> with the default
+// shared_read_policy, REGISTER_PARTITION_WITH_POLICY with the given policy
+// (e.g. unsynchronized_policy)
+#define PARTITION_TYPE(type, policy)                                           \
+  HPX_PP_CAT(__partition_type_, HPX_PP_CAT(type, policy))
+/**/
+
+#define PARTITION_TYPEDEF(type, policy)                                        \
+  typedef dist_object::server::partition<type, dist_object::policy>            \
+      PARTITION_TYPE(type, policy);
+/**/
+
 #define REGISTER_PARTITION_DECLARATION(type)                                   \
+  REGISTER_PARTITION_WITH_POLICY_DECLARATION(type, shared_read_policy)
+/**/
+
+#define REGISTER_PARTITION_WITH_POLICY_DECLARATION(type, policy)               \
+  PARTITION_TYPEDEF(type, policy)                                              \
+  HPX_REGISTER_ACTION_DECLARATION(                                             \
+      PARTITION_TYPE(type, policy)::size_action,                               \
+      HPX_PP_CAT(__partition_size_action_, HPX_PP_CAT(type, policy)));         \
+  HPX_REGISTER_ACTION_DECLARATION(                                             \
+      PARTITION_TYPE(type, policy)::fetch_action,                              \
+      HPX_PP_CAT(__partition_fetch_action_, HPX_PP_CAT(type, policy)));        \
+  HPX_REGISTER_ACTION_DECLARATION(                                             \
+      PARTITION_TYPE(type, policy)::fetch_range_action,                        \
+      HPX_PP_CAT(__partition_fetch_range_action_, HPX_PP_CAT(type, policy)));  \
+  HPX_REGISTER_ACTION_DECLARATION(                                             \
+      PARTITION_TYPE(type, policy)::fetch_buffer_action,                       \
+      HPX_PP_CAT(__partition_fetch_buffer_action_, HPX_PP_CAT(type, policy))); \
   HPX_REGISTER_ACTION_DECLARATION(                                             \
-                                                                               \
+      PARTITION_TYPE(type, policy)::fetch_pointer_action,                      \
+      HPX_PP_CAT(__partition_fetch_pointer_action_, HPX_PP_CAT(type, policy)));\
   HPX_REGISTER_ACTION_DECLARATION(                                             \
-      dist_object::server::partition<type>::size_action,                       \
-      HPX_PP_CAT(__partition_size_action_, type));                             \
+      PARTITION_TYPE(type, policy)::put_action,                                \
+      HPX_PP_CAT(__partition_put_action_, HPX_PP_CAT(type, policy)));          \
   HPX_REGISTER_ACTION_DECLARATION(                                             \
-      dist_object::server::partition<type>::fetch_action,                      \
-      HPX_PP_CAT(__partition_fetch_action_, type));                            \
+      PARTITION_TYPE(type, policy)::put_buffer_action,                         \
+      HPX_PP_CAT(__partition_put_buffer_action_, HPX_PP_CAT(type, policy)));   \
+  HPX_REGISTER_ACTION_DECLARATION(                                             \
+      PARTITION_TYPE(type, policy)::deposit_action,                            \
+      HPX_PP_CAT(__partition_deposit_action_, HPX_PP_CAT(type, policy)));      \
   /**/
 
 #define REGISTER_PARTITION(type)                                               \
-  HPX_REGISTER_ACTION(dist_object::server::partition<type>::size_action,       \
-                      HPX_PP_CAT(__partition_size_action_, type));             \
+  REGISTER_PARTITION_WITH_POLICY(type, shared_read_policy)
+/**/
+
+#define REGISTER_PARTITION_WITH_POLICY(type, policy)                           \
+  PARTITION_TYPEDEF(type, policy)                                              \
+  HPX_REGISTER_ACTION(                                                         \
+      PARTITION_TYPE(type, policy)::size_action,                               \
+      HPX_PP_CAT(__partition_size_action_, HPX_PP_CAT(type, policy)));         \
+  HPX_REGISTER_ACTION(                                                         \
+      PARTITION_TYPE(type, policy)::fetch_action,                              \
+      HPX_PP_CAT(__partition_fetch_action_, HPX_PP_CAT(type, policy)));        \
+  HPX_REGISTER_ACTION(                                                         \
+      PARTITION_TYPE(type, policy)::fetch_range_action,                        \
+      HPX_PP_CAT(__partition_fetch_range_action_, HPX_PP_CAT(type, policy)));  \
+  HPX_REGISTER_ACTION(                                                         \
+      PARTITION_TYPE(type, policy)::fetch_buffer_action,                       \
+      HPX_PP_CAT(__partition_fetch_buffer_action_, HPX_PP_CAT(type, policy))); \
+  HPX_REGISTER_ACTION(                                                         \
+      PARTITION_TYPE(type, policy)::fetch_pointer_action,                      \
+      HPX_PP_CAT(__partition_fetch_pointer_action_, HPX_PP_CAT(type, policy)));\
+  HPX_REGISTER_ACTION(                                                         \
+      PARTITION_TYPE(type, policy)::put_action,                                \
+      HPX_PP_CAT(__partition_put_action_, HPX_PP_CAT(type, policy)));          \
+  HPX_REGISTER_ACTION(                                                         \
+      PARTITION_TYPE(type, policy)::put_buffer_action,                         \
+      HPX_PP_CAT(__partition_put_buffer_action_, HPX_PP_CAT(type, policy)));   \
   HPX_REGISTER_ACTION(                                                         \
-      dist_object::server::partition<type>::fetch_action,                      \
-      HPX_PP_CAT(__partition_fetch_action_, type));                            \
-  typedef ::hpx::components::component<dist_object::server::partition<type>>   \
-      HPX_PP_CAT(__partition_, type);                                          \
-  HPX_REGISTER_COMPONENT(HPX_PP_CAT(__partition_, type))                       \
+      PARTITION_TYPE(type, policy)::deposit_action,                            \
+      HPX_PP_CAT(__partition_deposit_action_, HPX_PP_CAT(type, policy)));      \
+  typedef ::hpx::components::component<PARTITION_TYPE(type, policy)>           \
+      HPX_PP_CAT(__partition_, HPX_PP_CAT(type, policy));                      \
+  HPX_REGISTER_COMPONENT(HPX_PP_CAT(__partition_, HPX_PP_CAT(type, policy)))   \
   /**/
 #endif
@@ -5,9 +5,18 @@
 //  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
+#include "template_dist_object.hpp"
 #include <hpx/hpx.hpp>
 #include <hpx/runtime/components/component_factory.hpp>
 
 ///////////////////////////////////////////////////////////////////////////////
 // Add factory registration functionality.
 HPX_REGISTER_COMPONENT_MODULE();
+
+typedef hpx::components::component<dist_object::server::part_directory>
+	part_directory_type;
+
+HPX_REGISTER_COMPONENT(part_directory_type, part_directory);
+
+HPX_REGISTER_ACTION(part_directory_type::get_parts_action,
+	part_directory_get_parts_action);
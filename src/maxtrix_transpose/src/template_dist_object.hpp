@@ -8,27 +8,143 @@
 #if !defined(HPX_TEMPLATE_DIST_OBJECT_SERVER_MAR_20_2019_0328PM)
 #define HPX_TEMPLATE_DIST_OBJECT_SERVER_MAR_20_2019_0328PM
 
+#include <hpx/include/apply.hpp>
 #include <hpx/include/components.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/lcos/local/promise.hpp>
 #include <hpx/util/assert.hpp>
 
 #include "server/template_dist_object.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+// The id_cache holds the ids of the partitions of a dist_object. It is shared
+// by all copies of a dist_object client. The dist_object_array caches the
+// partition lists of the localities the same way
 namespace dist_object {
-	template <typename T>
+	namespace detail {
+		// Fixed-size, lock-free table of (future) values indexed by locality.
+		// The first lookup of an index installs its entry with a single
+		// compare-and-swap, so concurrent lookups of the same index share one
+		// query and nobody blocks while it is in flight.
+		template <typename Value>
+		class future_cache
+			: public std::enable_shared_from_this<future_cache<Value>> {
+			struct entry {
+				entry() : value(promise.get_future()) {}
+
+				explicit entry(Value const& known)
+					: value(hpx::make_ready_future(known)) {}
+
+				hpx::lcos::local::promise<Value> promise;
+				hpx::shared_future<Value> value;
+			};
+
+		public:
+			explicit future_cache(std::size_t size)
+				: size_(size), entries_(new std::atomic<entry*>[size])
+			{
+				for (std::size_t i = 0; i != size_; ++i)
+					entries_[i].store(nullptr, std::memory_order_relaxed);
+			}
+
+			~future_cache()
+			{
+				for (std::size_t i = 0; i != size_; ++i)
+					delete entries_[i].load(std::memory_order_relaxed);
+			}
+
+			future_cache(future_cache const&) = delete;
+			future_cache& operator=(future_cache const&) = delete;
+
+			std::size_t size() const { return size_; }
+
+			// Returns the (future) value for the given index. lookup is invoked
+			// only by the first caller asking for that index and has to
+			// return a hpx::future<Value>
+			template <typename Lookup>
+			hpx::shared_future<Value> get(std::size_t idx, Lookup&& lookup)
+			{
+				HPX_ASSERT(idx < size_);
+				entry* e = entries_[idx].load(std::memory_order_acquire);
+				if (e)
+					return e->value;
+
+				std::unique_ptr<entry> created(new entry);
+				if (!entries_[idx].compare_exchange_strong(e, created.get(),
+					std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					// somebody else's query for this index is in flight
+					return e->value;
+				}
+
+				e = created.release();
+				std::shared_ptr<future_cache> self = this->shared_from_this();
+				lookup().then(hpx::launch::sync,
+					[self, e](hpx::future<Value> f)
+					{
+						try {
+							e->promise.set_value(f.get());
+						}
+						catch (...) {
+							e->promise.set_exception(std::current_exception());
+						}
+					});
+				return e->value;
+			}
+
+			// Seeds the table with a value which is already known
+			void set(std::size_t idx, Value const& value)
+			{
+				HPX_ASSERT(idx < size_);
+				std::unique_ptr<entry> created(new entry(value));
+				entry* expected = nullptr;
+				if (entries_[idx].compare_exchange_strong(expected,
+					created.get(), std::memory_order_acq_rel))
+				{
+					created.release();
+				}
+			}
+
+		private:
+			std::size_t size_;
+			std::unique_ptr<std::atomic<entry*>[]> entries_;
+		};
+
+		typedef future_cache<hpx::id_type> id_cache;
+	}
+}
+
+namespace dist_object {
+	template <typename T, typename Policy = shared_read_policy>
 	class dist_object
-		: hpx::components::client_base<dist_object<T>, server::partition<T>> {
-		typedef hpx::components::client_base<dist_object<T>, server::partition<T>>
+		: hpx::components::client_base<dist_object<T, Policy>,
+			server::partition<T, Policy>> {
+		typedef server::partition<T, Policy> server_type;
+		typedef hpx::components::client_base<dist_object<T, Policy>, server_type>
 			base_type;
 
-		typedef typename server::partition<T>::data_type data_type;
+		typedef typename server_type::data_type data_type;
+
+	public:
+		typedef typename server_type::buffer_type buffer_type;
+
+	private:
+		typedef typename server_type::pointer_buffer_type
+			pointer_buffer_type;
 
 	private:
 		template <typename Arg>
 		static hpx::future<hpx::id_type> create_server(Arg &&value) {
-			return hpx::new_<server::partition<T>>(hpx::find_here(), std::forward<Arg>(value));
+			return hpx::new_<server_type>(hpx::find_here(), std::forward<Arg>(value));
 		}
 
 	public:
@@ -90,35 +206,514 @@ namespace dist_object {
 			return &**ptr;
 		}
 
+		// Resolves the ids of the partitions owned by all localities at once.
+		// The lookups are issued concurrently and cached, so that later
+		// requests do not pay for them on their critical path. The returned
+		// future becomes ready once all ids are known
+		hpx::future<void> resolve_all()
+		{
+			HPX_ASSERT(this->get_id());
+			std::vector<hpx::shared_future<hpx::id_type>> ids;
+			ids.reserve(num_localities_);
+			for (std::size_t loc = 0; loc != num_localities_; ++loc)
+				ids.push_back(get_basename_helper(static_cast<int>(loc)));
+
+			return hpx::when_all(ids).then(hpx::launch::sync,
+				[](hpx::future<std::vector<hpx::shared_future<hpx::id_type>>> f)
+				{
+					// rethrow any failed lookup
+					for (auto const& id : f.get())
+						id.get();
+				});
+		}
+
 		hpx::future<data_type> fetch(int idx)
 		{
 			HPX_ASSERT(this->get_id());
-			hpx::id_type lookup = get_basename_helper(idx);
-			typedef typename server::partition<T>::fetch_action
+			typedef typename server_type::fetch_action
+				action_type;
+			return async_on<action_type>(idx);
+		}
+
+		// Request only the elements [offset, offset + count) of the
+		// partition owned by the locality specified by the supplied index
+		hpx::future<data_type> fetch(int idx, std::size_t offset,
+			std::size_t count)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::fetch_range_action
+				action_type;
+			return async_on<action_type>(idx, offset, count);
+		}
+
+		// Zero-copy variant of the ranged fetch: the elements are serialized
+		// directly out of the remote partition and received into a buffer
+		// owned by the caller, without intermediate std::vector copies
+		hpx::future<buffer_type> fetch_buffer(int idx, std::size_t offset,
+			std::size_t count)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::fetch_buffer_action
 				action_type;
-			return hpx::async<action_type>(lookup);
+			return async_on<action_type>(idx, offset, count);
+		}
+
+		// Deserializes the elements [offset, offset + count) of the partition
+		// owned by the locality specified by the supplied index directly into
+		// the memory pointed to by dest, which has to stay valid until the
+		// returned future becomes ready
+		hpx::future<void> fetch_into(int idx, std::size_t offset,
+			std::size_t count, T* dest)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::fetch_pointer_action
+				action_type;
+			return async_on<action_type>(idx, offset, count,
+				reinterpret_cast<std::size_t>(dest)).then(
+				[dest](hpx::future<pointer_buffer_type> f)
+				{
+					// local requests are not serialized, the buffer then
+					// still references the partition itself
+					pointer_buffer_type buffer = f.get();
+					if (buffer.data() != dest)
+						std::copy(buffer.data(), buffer.data() + buffer.size(),
+							dest);
+				});
+		}
+
+		// Overwrites the partition owned by the locality specified by the
+		// supplied index
+		hpx::future<void> put(int idx, data_type const& value)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::put_action action_type;
+			return async_on<action_type>(idx, value);
+		}
+
+		// Overwrites the elements [offset, offset + count) of the partition
+		// owned by the locality specified by the supplied index. The
+		// elements pointed to by data are serialized in place and have to
+		// stay valid until the returned future becomes ready
+		hpx::future<void> put(int idx, std::size_t offset, T const* data,
+			std::size_t count)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::put_buffer_action
+				action_type;
+			return async_on<action_type>(idx, offset,
+				buffer_type(const_cast<T*>(data), count, buffer_type::reference));
+		}
+
+		// Fire-and-forget variant of the ranged put, for bulk pushes which
+		// are synchronized by other means (e.g. a barrier). The elements are
+		// copied right away, so data may be reused as soon as this returns
+		void apply_put(int idx, std::size_t offset, T const* data,
+			std::size_t count)
+		{
+			HPX_ASSERT(this->get_id());
+			typedef typename server_type::put_buffer_action
+				action_type;
+			apply_on<action_type>(idx, offset,
+				buffer_type(const_cast<T*>(data), count, buffer_type::copy));
+		}
+
+		// Personalized all-to-all exchange. Every locality sends the
+		// elements [send_offsets[i], send_offsets[i] + send_counts[i]) of its
+		// partition to locality i, and what arrives from locality i is copied
+		// to recv + recv_offsets[i]. In step k each locality sends to
+		// rank + k and receives from rank - k, so every pair of localities
+		// exchanges exactly once and no locality is flooded; at most
+		// max_concurrent sends are in flight at a time. The slices are sent
+		// straight out of the partition, which must not be modified, and
+		// recv must stay valid, until the returned future becomes ready.
+		// Must be called by all localities in the same order
+		hpx::future<void> all_to_all(std::vector<std::size_t> const& send_offsets,
+			std::vector<std::size_t> const& send_counts, T* recv,
+			std::vector<std::size_t> const& recv_offsets,
+			std::size_t max_concurrent = 8)
+		{
+			HPX_ASSERT(this->get_id());
+			HPX_ASSERT(send_offsets.size() == num_localities_);
+			HPX_ASSERT(send_counts.size() == num_localities_);
+			HPX_ASSERT(recv_offsets.size() == num_localities_);
+			if (max_concurrent == 0)
+				max_concurrent = 1;
+			typedef typename server_type::deposit_action action_type;
+
+			ensure_ptr();
+			std::size_t const n = num_localities_;
+			std::size_t const rank = hpx::get_locality_id();
+			std::uint64_t const seq = next_sequence();
+			T* local = (**ptr).data();
+
+			std::copy(local + send_offsets[rank],
+				local + send_offsets[rank] + send_counts[rank],
+				recv + recv_offsets[rank]);
+
+			std::vector<hpx::shared_future<void>> sends;
+			std::vector<hpx::future<void>> receives;
+			sends.reserve(n);
+			receives.reserve(n);
+			for (std::size_t k = 1; k < n; ++k) {
+				std::uint64_t const tag = make_tag(seq, k);
+				int const dest = static_cast<int>((rank + k) % n);
+				std::size_t const src = (rank + n - k) % n;
+
+				buffer_type payload(local + send_offsets[dest],
+					send_counts[dest], buffer_type::reference);
+				if (k > max_concurrent) {
+					// wait for a slot of the window to become free
+					dist_object self(*this);
+					sends.push_back(sends[k - 1 - max_concurrent].then(
+						hpx::launch::sync,
+						[self, dest, tag, payload](
+							hpx::shared_future<void> f) mutable
+						{
+							f.get();
+							return self.template async_on<action_type>(dest,
+								tag, payload);
+						}).share());
+				}
+				else {
+					sends.push_back(
+						async_on<action_type>(dest, tag, payload).share());
+				}
+
+				T* dest_mem = recv + recv_offsets[src];
+				receives.push_back(ptr->receive(tag).then(hpx::launch::sync,
+					[dest_mem](hpx::future<buffer_type> f)
+					{
+						buffer_type buffer = f.get();
+						std::copy(buffer.data(), buffer.data() + buffer.size(),
+							dest_mem);
+					}));
+			}
+
+			return hpx::dataflow(hpx::launch::sync,
+				[](hpx::future<std::vector<hpx::shared_future<void>>> s,
+					hpx::future<std::vector<hpx::future<void>>> r)
+				{
+					// rethrow any failed transfer
+					for (auto const& f : s.get())
+						f.get();
+					for (auto& f : r.get())
+						f.get();
+				},
+				hpx::when_all(sends), hpx::when_all(receives));
 		}
 
 	private:
-		mutable std::shared_ptr<server::partition<T>> ptr;
+		mutable std::shared_ptr<server_type> ptr;
 		std::string base_;
 		void ensure_ptr() const {
 			if (!ptr) {
-				ptr = hpx::get_ptr<server::partition<T>>(hpx::launch::sync, get_id());
+				ptr = hpx::get_ptr<server_type>(hpx::launch::sync, get_id());
 			}
 		}
 	private:
-		std::vector<hpx::id_type> basename_list;
-		hpx::id_type get_basename_helper(int idx) {
-			if (!basename_list[idx]) {
-				basename_list[idx] = hpx::find_from_basename(base_ + std::to_string(idx), idx).get();
+		std::shared_ptr<detail::id_cache> ids_;
+		std::size_t num_localities_ = 0;
+		// Counts the collective operations issued on this object, keeps
+		// the messages of consecutive operations apart
+		std::shared_ptr<std::atomic<std::uint64_t>> sequence_;
+
+		std::uint64_t next_sequence()
+		{
+			HPX_ASSERT(sequence_);
+			return (*sequence_)++;
+		}
+
+		static std::uint64_t make_tag(std::uint64_t seq, std::uint64_t step)
+		{
+			return (seq << 32) | step;
+		}
+
+		// Returns the (future) id of the partition owned by the locality
+		// specified by the supplied index, looking it up on first use
+		hpx::shared_future<hpx::id_type> get_basename_helper(int idx) {
+			HPX_ASSERT(ids_);
+			std::string const& base = base_;
+			return ids_->get(idx, [&base, idx]() {
+				return hpx::find_from_basename(base + std::to_string(idx), idx);
+			});
+		}
+
+		// Invokes the action on the partition owned by the locality specified
+		// by the supplied index, chained to the lookup of its id if that is
+		// not known yet
+		template <typename Action, typename... Ts>
+		auto async_on(int idx, Ts const&... vs)
+			-> decltype(hpx::async<Action>(std::declval<hpx::id_type>(), vs...))
+		{
+			hpx::shared_future<hpx::id_type> id = get_basename_helper(idx);
+			if (id.is_ready())
+				return hpx::async<Action>(id.get(), vs...);
+			return id.then(
+				[=](hpx::shared_future<hpx::id_type> f)
+				{
+					return hpx::async<Action>(f.get(), vs...);
+				});
+		}
+
+		template <typename Action, typename... Ts>
+		void apply_on(int idx, Ts const&... vs)
+		{
+			hpx::shared_future<hpx::id_type> id = get_basename_helper(idx);
+			if (id.is_ready()) {
+				hpx::apply<Action>(id.get(), vs...);
+				return;
 			}
-			return basename_list[idx];
+			id.then(
+				[=](hpx::shared_future<hpx::id_type> f)
+				{
+					hpx::apply<Action>(f.get(), vs...);
+				});
 		}
+
 		void basename_registration_helper(std::string base) {
 			hpx::register_with_basename(base + std::to_string(hpx::get_locality_id()), get_id());
-			basename_list.resize(hpx::find_all_localities().size());
+			num_localities_ = hpx::find_all_localities().size();
+			ids_ = std::make_shared<detail::id_cache>(num_localities_);
+			ids_->set(hpx::get_locality_id(), get_id());
+			sequence_ = std::make_shared<std::atomic<std::uint64_t>>(0);
+		}
+	};
+}
+
+// The dist_object_array creates several partitions per locality as one unit.
+// The partitions of a locality are listed by a single part_directory, which
+// is the only thing registered with AGAS, so construction and lookups do not
+// grow with the number of partitions. A partition is addressed by the
+// locality owning it and its index there.
+namespace dist_object {
+	template <typename T, typename Policy = shared_read_policy>
+	class dist_object_array {
+		typedef server::partition<T, Policy> server_type;
+		typedef server::part_directory directory_type;
+		typedef std::vector<hpx::id_type> parts_type;
+
+	public:
+		typedef typename server_type::data_type data_type;
+		typedef typename server_type::buffer_type buffer_type;
+
+	private:
+		typedef typename server_type::pointer_buffer_type
+			pointer_buffer_type;
+
+	public:
+		dist_object_array() {}
+
+		// Creates num_parts partitions on this locality, all initialized
+		// with init
+		dist_object_array(std::string base, std::size_t num_parts,
+			data_type const& init)
+			: base_(base)
+		{
+			registration_helper(hpx::new_<server_type[]>(hpx::find_here(),
+				num_parts, init).get());
+		}
+
+		// Creates one partition on this locality for each element of parts
+		dist_object_array(std::string base, std::vector<data_type> const& parts)
+			: base_(base)
+		{
+			std::vector<hpx::future<hpx::id_type>> ids;
+			ids.reserve(parts.size());
+			for (data_type const& part : parts)
+				ids.push_back(hpx::new_<server_type>(hpx::find_here(), part));
+
+			parts_type local_ids;
+			local_ids.reserve(ids.size());
+			for (hpx::future<hpx::id_type>& id : ids)
+				local_ids.push_back(id.get());
+			registration_helper(std::move(local_ids));
+		}
+
+		// Number of partitions on this locality
+		std::size_t size() const
+		{
+			return local_ids_.size();
+		}
+
+		// Direct access to the partitions on this locality
+		data_type& local(std::size_t i)
+		{
+			HPX_ASSERT(i < local_ptrs_.size());
+			return **local_ptrs_[i];
+		}
+
+		data_type const& local(std::size_t i) const
+		{
+			HPX_ASSERT(i < local_ptrs_.size());
+			return **local_ptrs_[i];
+		}
+
+		// Resolves the partition lists of all localities at once, see
+		// dist_object::resolve_all
+		hpx::future<void> resolve_all()
+		{
+			std::vector<hpx::shared_future<parts_type>> parts;
+			parts.reserve(num_localities_);
+			for (std::size_t loc = 0; loc != num_localities_; ++loc)
+				parts.push_back(get_parts_helper(loc));
+
+			return hpx::when_all(parts).then(hpx::launch::sync,
+				[](hpx::future<std::vector<hpx::shared_future<parts_type>>> f)
+				{
+					// rethrow any failed lookup
+					for (auto const& p : f.get())
+						p.get();
+				});
+		}
+
+		// Id of the partition i of locality loc
+		hpx::future<hpx::id_type> part_id(std::size_t loc, std::size_t i)
+		{
+			return get_parts_helper(loc).then(hpx::launch::sync,
+				[i](hpx::shared_future<parts_type> f)
+				{
+					HPX_ASSERT(i < f.get().size());
+					return f.get()[i];
+				});
+		}
+
+		hpx::future<data_type> fetch(std::size_t loc, std::size_t i)
+		{
+			typedef typename server_type::fetch_action action_type;
+			return async_on<action_type>(loc, i);
+		}
+
+		hpx::future<data_type> fetch(std::size_t loc, std::size_t i,
+			std::size_t offset, std::size_t count)
+		{
+			typedef typename server_type::fetch_range_action action_type;
+			return async_on<action_type>(loc, i, offset, count);
+		}
+
+		hpx::future<buffer_type> fetch_buffer(std::size_t loc, std::size_t i,
+			std::size_t offset, std::size_t count)
+		{
+			typedef typename server_type::fetch_buffer_action action_type;
+			return async_on<action_type>(loc, i, offset, count);
+		}
+
+		// See dist_object::fetch_into
+		hpx::future<void> fetch_into(std::size_t loc, std::size_t i,
+			std::size_t offset, std::size_t count, T* dest)
+		{
+			typedef typename server_type::fetch_pointer_action action_type;
+			return async_on<action_type>(loc, i, offset, count,
+				reinterpret_cast<std::size_t>(dest)).then(
+				[dest](hpx::future<pointer_buffer_type> f)
+				{
+					pointer_buffer_type buffer = f.get();
+					if (buffer.data() != dest)
+						std::copy(buffer.data(), buffer.data() + buffer.size(),
+							dest);
+				});
 		}
+
+		hpx::future<void> put(std::size_t loc, std::size_t i,
+			data_type const& value)
+		{
+			typedef typename server_type::put_action action_type;
+			return async_on<action_type>(loc, i, value);
+		}
+
+		// See dist_object::put, data has to stay valid until the returned
+		// future becomes ready
+		hpx::future<void> put(std::size_t loc, std::size_t i,
+			std::size_t offset, T const* data, std::size_t count)
+		{
+			typedef typename server_type::put_buffer_action action_type;
+			return async_on<action_type>(loc, i, offset,
+				buffer_type(const_cast<T*>(data), count, buffer_type::reference));
+		}
+
+		void apply_put(std::size_t loc, std::size_t i, std::size_t offset,
+			T const* data, std::size_t count)
+		{
+			typedef typename server_type::put_buffer_action action_type;
+			apply_on<action_type>(loc, i, offset,
+				buffer_type(const_cast<T*>(data), count, buffer_type::copy));
+		}
+
+	private:
+		// Returns the (future) ids of the partitions of the given locality,
+		// one AGAS lookup and one request to its directory on first use
+		hpx::shared_future<parts_type> get_parts_helper(std::size_t loc)
+		{
+			HPX_ASSERT(parts_);
+			std::string const& base = base_;
+			return parts_->get(loc, [&base, loc]() {
+				typedef directory_type::get_parts_action action_type;
+				return hpx::find_from_basename(base + std::to_string(loc), loc)
+					.then([](hpx::future<hpx::id_type> f)
+					{
+						return hpx::async<action_type>(f.get());
+					});
+			});
+		}
+
+		template <typename Action, typename... Ts>
+		auto async_on(std::size_t loc, std::size_t i, Ts const&... vs)
+			-> decltype(hpx::async<Action>(std::declval<hpx::id_type>(), vs...))
+		{
+			hpx::shared_future<parts_type> parts = get_parts_helper(loc);
+			if (parts.is_ready()) {
+				HPX_ASSERT(i < parts.get().size());
+				return hpx::async<Action>(parts.get()[i], vs...);
+			}
+			return parts.then(
+				[=](hpx::shared_future<parts_type> f)
+				{
+					HPX_ASSERT(i < f.get().size());
+					return hpx::async<Action>(f.get()[i], vs...);
+				});
+		}
+
+		template <typename Action, typename... Ts>
+		void apply_on(std::size_t loc, std::size_t i, Ts const&... vs)
+		{
+			hpx::shared_future<parts_type> parts = get_parts_helper(loc);
+			if (parts.is_ready()) {
+				hpx::apply<Action>(parts.get()[i], vs...);
+				return;
+			}
+			parts.then(
+				[=](hpx::shared_future<parts_type> f)
+				{
+					hpx::apply<Action>(f.get()[i], vs...);
+				});
+		}
+
+		void registration_helper(parts_type local_ids)
+		{
+			local_ids_ = std::move(local_ids);
+			local_ptrs_.reserve(local_ids_.size());
+			for (hpx::id_type const& id : local_ids_) {
+				local_ptrs_.push_back(
+					hpx::get_ptr<server_type>(hpx::launch::sync, id));
+			}
+
+			std::size_t here = hpx::get_locality_id();
+			directory_ = hpx::new_<directory_type>(hpx::find_here(),
+				local_ids_).get();
+			hpx::register_with_basename(base_ + std::to_string(here),
+				directory_);
+
+			num_localities_ = hpx::find_all_localities().size();
+			parts_ = std::make_shared<detail::future_cache<parts_type>>(
+				num_localities_);
+			parts_->set(here, local_ids_);
+		}
+
+		std::string base_;
+		parts_type local_ids_;
+		std::vector<std::shared_ptr<server_type>> local_ptrs_;
+		hpx::id_type directory_;
+		std::size_t num_localities_ = 0;
+		std::shared_ptr<detail::future_cache<parts_type>> parts_;
 	};
 }
 
@@ -26,7 +26,9 @@
 #include <hpx/lcos/when_all.hpp>
 #include <hpx/parallel/algorithms/for_each.hpp>
 
+#include "plan.hpp"
 #include "template_dist_object.hpp"
+#include "transpose_kernel.hpp"
 
 #include <boost/range/irange.hpp>
 
@@ -37,6 +39,7 @@
 #include <vector>
 
 bool verbose = false; // command line argument
+bool cache_oblivious = false; // command line argument
 
 typedef double* sub_block;
 
@@ -47,19 +50,45 @@ typedef double* sub_block;
 REGISTER_PARTITION(double);
 
 ///////////////////////////////////////////////////////////////////////////////
-// transpose matrix when the target matrix is in a remote node
-void transpose(hpx::future<std::vector<double> > Af, std::uint64_t A_offset,
-	dist_object::dist_object<double>& B_temp, std::uint64_t B_offset,
-	std::uint64_t block_size, std::uint64_t block_order, std::uint64_t tile_size);
+// The columns of the matrix are split into num_blocks blocks as evenly as
+// possible, the first order % num_blocks blocks are one column wider. Block
+// b is stored row by row, order rows of width(b) elements
+struct column_blocks
+{
+	column_blocks(std::uint64_t order, std::uint64_t num_blocks)
+		: order(order), num_blocks(num_blocks)
+	{}
+
+	std::uint64_t start(std::uint64_t b) const
+	{
+		return b * (order / num_blocks) + (std::min)(b, order % num_blocks);
+	}
+
+	std::uint64_t width(std::uint64_t b) const
+	{
+		return start(b + 1) - start(b);
+	}
+
+	std::uint64_t order;
+	std::uint64_t num_blocks;
+};
 
 ///////////////////////////////////////////////////////////////////////////////
-// transpose matrix when the target and destination matrix are in a same node
-void transpose_local(dist_object::dist_object<double>& A_temp, std::uint64_t A_offset,
-	dist_object::dist_object<double>& B_temp, std::uint64_t B_offset,
-	std::uint64_t block_size, std::uint64_t block_order, std::uint64_t tile_size);
+// transpose matrix when the target matrix is in a remote node, Af becomes
+// ready once the remote tile has been received into A_buffer
+void transpose(hpx::future<void> Af, sub_block A_buffer, std::uint64_t A_offset,
+	sub_block B_block, std::uint64_t B_offset,
+	std::uint64_t rows, std::uint64_t cols, std::uint64_t tile_size);
 
-double test_results(std::uint64_t order, std::uint64_t block_order,
-	std::vector<dist_object::dist_object<double>> & trans, std::uint64_t blocks_start,
+///////////////////////////////////////////////////////////////////////////////
+// transpose matrix when the target and destination matrix are in a same node,
+// the tile of A has rows x cols elements and is stored row by row
+void transpose_local(sub_block A_block, std::uint64_t A_offset,
+	sub_block B_block, std::uint64_t B_offset,
+	std::uint64_t rows, std::uint64_t cols, std::uint64_t tile_size);
+
+double test_results(column_blocks const& blocks,
+	dist_object::dist_object_array<double> & trans, std::uint64_t blocks_start,
 	std::uint64_t blocks_end);
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -72,36 +101,52 @@ void run_matrix_transposition(boost::program_options::variables_map& vm) {
 	std::uint64_t order = vm["matrix_size"].as<std::uint64_t>();
 	std::uint64_t iterations = vm["iterations"].as<std::uint64_t>();
 	std::uint64_t num_local_blocks = vm["num_blocks"].as<std::uint64_t>();
-	std::uint64_t tile_size = order;
+	// zero selects the tile size from the cache sizes
+	std::uint64_t tile_size = 0;
 
 	if (vm.count("tile_size"))
 		tile_size = vm["tile_size"].as<std::uint64_t>();
 
+	// zero fetches all remote tiles of a block at once
+	std::uint64_t pipeline_depth = vm["pipeline_depth"].as<std::uint64_t>();
+
 	verbose = vm.count("verbose") ? true : false;
+	cache_oblivious = vm.count("cache_oblivious") ? true : false;
+	bool const all_to_all = vm.count("all_to_all") ? true : false;
+
+	if (all_to_all && num_local_blocks != 1)
+	{
+		if (root)
+			hpx::cout << "ERROR: all_to_all requires num_blocks = 1\n";
+		return;
+	}
 
 	std::uint64_t bytes =
 		static_cast<std::uint64_t>(2.0 * sizeof(double) * order * order);
 
 	std::uint64_t num_blocks = num_localities * num_local_blocks;
 
-	std::uint64_t block_order = order / num_blocks;
-	std::uint64_t col_block_size = order * block_order;
+	if (pipeline_depth == 0 || pipeline_depth > num_blocks)
+		pipeline_depth = num_blocks;
 
-	std::uint64_t id = hpx::get_locality_id();
+	// order does not have to be a multiple of num_blocks, see column_blocks
+	column_blocks const blocks(order, num_blocks);
 
-	std::vector<dist_object::dist_object<double>> A(num_blocks);
-	std::vector<dist_object::dist_object<double>> B(num_blocks);
+	std::uint64_t id = hpx::get_locality_id();
 
 	std::uint64_t blocks_start = id * num_local_blocks;
 	std::uint64_t blocks_end = (id + 1) * num_local_blocks;
 
-	// First allocate and create our local blocks
-	for (std::uint64_t b = 0; b != num_local_blocks; ++b)
-	{
-		std::uint64_t block_idx = b + blocks_start;
-		A[block_idx] = dist_object::dist_object<double>("A", std::vector<double>(col_block_size));
-		B[block_idx] = dist_object::dist_object<double>("B", std::vector<double>(col_block_size));
-	}
+	// First allocate and create our local blocks, block b is the local
+	// partition b % num_local_blocks of locality b / num_local_blocks
+	std::vector<std::vector<double> > parts;
+	parts.reserve(num_local_blocks);
+	for (std::uint64_t b = blocks_start; b != blocks_end; ++b)
+		parts.push_back(std::vector<double>(order * blocks.width(b)));
+
+	dist_object::dist_object_array<double> A("A", parts);
+	dist_object::dist_object_array<double> B("B", parts);
+	parts.clear();
 
 	using hpx::parallel::for_each;
 	using hpx::parallel::execution::par;
@@ -111,18 +156,41 @@ void run_matrix_transposition(boost::program_options::variables_map& vm) {
 	hpx::parallel::for_each(par, std::begin(range), std::end(range),
 		[&](std::uint64_t b)
 	{
+		const std::uint64_t width = blocks.width(b);
 		for (std::uint64_t i = 0; i != order; ++i)
 		{
-			for (std::uint64_t j = 0; j != block_order; ++j)
+			for (std::uint64_t j = 0; j != width; ++j)
 			{
-				double col_val = COL_SHIFT * (b*block_order + j);
-				(*A[b])[i * block_order + j] = col_val + ROW_SHIFT * i;
-				(*B[b])[i * block_order + j] = -1.0;
+				double col_val = COL_SHIFT * (blocks.start(b) + j);
+				A.local(b - blocks_start)[i * width + j] =
+					col_val + ROW_SHIFT * i;
+				B.local(b - blocks_start)[i * width + j] = -1.0;
 			}
 		}
 	}
 	);
 
+	// With all_to_all, each locality sends the rows of its column block
+	// which belong to the columns of locality p to p, in one collective. What
+	// arrives from locality q is received at the same offset its
+	// transposition has in B, once all arrived they are transposed in
+	// parallel
+	dist_object::dist_object<double> A_whole;
+	std::vector<std::size_t> a2a_send_offsets, a2a_send_counts, a2a_recv_offsets;
+	std::vector<double> a2a_recv;
+	if (all_to_all)
+	{
+		A_whole = dist_object::dist_object<double>("A_all_to_all", A.local(0));
+		const std::uint64_t width = blocks.width(id);
+		for (std::uint64_t p = 0; p != num_blocks; ++p)
+		{
+			a2a_send_offsets.push_back(blocks.start(p) * width);
+			a2a_send_counts.push_back(blocks.width(p) * width);
+		}
+		a2a_recv_offsets = a2a_send_offsets;
+		a2a_recv.resize(order * width);
+	}
+
 	// wait all matrix to be initialized
 	hpx::lcos::barrier b("wait_for_init", hpx::find_all_localities().size(), hpx::get_locality_id());
 	b.wait();
@@ -132,17 +200,59 @@ void run_matrix_transposition(boost::program_options::variables_map& vm) {
 		hpx::cout
 			<< "Serial Matrix transpose: B = A^T\n"
 			<< "Matrix order           = " << order << "\n"
-			<< "Matrix local columns   = " << block_order << "\n"
+			<< "Matrix local columns   = " << blocks.width(num_blocks - 1)
+				<< " to " << blocks.width(0) << "\n"
 			<< "Total number of blocks = " << num_blocks << "\n"
 			<< "Number of localities   = " << num_localities << "\n";
-		if (tile_size < order)
+		if (cache_oblivious)
+			hpx::cout << "Tile size             = none (cache oblivious)\n";
+		else if (tile_size != 0)
 			hpx::cout << "Tile size             = " << tile_size << "\n";
 		else
-			hpx::cout << "Untiled\n";
+			hpx::cout << "Tile size (automatic) = "
+				<< dist_object::kernels::blocking<double>::inner() << "\n";
 		hpx::cout
+			<< "Pipeline depth        = " << pipeline_depth << "\n"
+			<< "Exchange              = "
+				<< (all_to_all ? "all_to_all" : "fetch") << "\n"
 			<< "Number of iterations  = " << iterations << "\n";
 	}
 
+	// Receive buffers for the remote tiles, pipeline_depth per local block.
+	// The remote phases of a block use them in turn, a tile is fetched only
+	// once the transposition of the tile received before into the same
+	// buffer is done. At most pipeline_depth tiles per block are in flight
+	// or waiting to be transposed, while the others are transposed the next
+	// ones are received. The widest blocks are the first ones.
+	dist_object::plan<double> fetches(A);
+	std::vector<sub_block> recv_buffers(num_local_blocks * pipeline_depth);
+	for (sub_block& recv : recv_buffers)
+		recv = fetches.allocate(blocks.width(0) * blocks.width(0));
+
+	// The fetches of the remote tiles are the same in all iterations, they
+	// are recorded once, indexed by local block and phase. Committing the
+	// plan resolves the ids of all partitions up front, the lookups would
+	// otherwise end up on the critical path of the first iteration
+	std::vector<std::size_t> fetch_ops(num_local_blocks * num_blocks);
+	for (std::uint64_t b = blocks_start; b != blocks_end && !all_to_all; ++b)
+	{
+		std::uint64_t remote_phases = 0;
+		for (std::uint64_t k = 0; k != num_blocks; ++k)
+		{
+			const std::uint64_t phase = (b + k) % num_blocks;
+			if (blocks_start <= phase && phase < blocks_end)
+				continue;
+
+			const std::uint64_t slot = remote_phases++ % pipeline_depth;
+			const std::uint64_t cols = blocks.width(phase);
+			fetch_ops[(b - blocks_start) * num_blocks + phase] = fetches.read(
+				phase / num_local_blocks, phase % num_local_blocks,
+				blocks.start(b) * cols, blocks.width(b) * cols,
+				recv_buffers[(b - blocks_start) * pipeline_depth + slot]);
+		}
+	}
+	fetches.commit().get();
+
 	double errsq = 0.0;
 	double avgtime = 0.0;
 	double maxtime = 0.0;
@@ -156,59 +266,107 @@ void run_matrix_transposition(boost::program_options::variables_map& vm) {
 		std::vector<hpx::future<void> > block_futures;
 		block_futures.resize(num_local_blocks);
 		hpx::util::high_resolution_timer t;
-		for_each(par, std::begin(range), std::end(range),
-			[&](std::uint64_t b)
+		if (all_to_all)
 		{
-			std::vector<hpx::future<void> > phase_futures;
-			phase_futures.reserve(num_blocks);
+			// the window of the exchange is the pipeline depth
+			A_whole.all_to_all(a2a_send_offsets, a2a_send_counts,
+				a2a_recv.data(), a2a_recv_offsets, pipeline_depth).get();
 
-			auto phase_range = boost::irange(
+			auto locality_range = boost::irange(
 				static_cast<std::uint64_t>(0), num_blocks);
-			for (std::uint64_t phase : phase_range)
+			for_each(par, std::begin(locality_range), std::end(locality_range),
+				[&](std::uint64_t q)
 			{
-				const std::uint64_t block_size = block_order * block_order;
-				const std::uint64_t from_block = phase;
-				const std::uint64_t from_phase = b;
-				const std::uint64_t A_offset = from_phase * block_size;
-				const std::uint64_t B_offset = phase * block_size;
-				const std::uint64_t from_locality = from_block % num_localities;
-				// Perform matrix transposition locally
-				if (blocks_start <= phase && phase < blocks_end) {
-					phase_futures.push_back(
-						hpx::async(&transpose_local
-							, A[from_block]
-							, A_offset
-							, B[b]
-							, B_offset
-							, block_size
-							, block_order
-							, tile_size
-						)
-					);
-				}
-				// fetch remote matrix and then transpose the matrix
-				else {
-					phase_futures.push_back(
-						hpx::dataflow(
-							&transpose
-							, A[b].fetch(from_locality)
-							, A_offset
-							, B[b]
-							, B_offset
-							, block_size
-							, block_order
-							, tile_size
-						)
-					);
+				transpose_local(a2a_recv.data(), a2a_recv_offsets[q],
+					B.local(0).data(), a2a_recv_offsets[q], blocks.width(id),
+					blocks.width(q), tile_size);
+			}
+			);
+		}
+		else
+		{
+			for_each(par, std::begin(range), std::end(range),
+				[&](std::uint64_t b)
+			{
+				std::vector<hpx::shared_future<void> > phase_futures;
+				phase_futures.reserve(num_blocks);
+
+				// the transposition which used a receive buffer last
+				std::vector<hpx::shared_future<void> > buffer_free(
+					pipeline_depth, hpx::make_ready_future());
+				std::uint64_t remote_phases = 0;
+
+				// start with the own block and then go round, so that not all
+				// localities fetch from the same one at the same time
+				auto phase_range = boost::irange(
+					static_cast<std::uint64_t>(0), num_blocks);
+				for (std::uint64_t k : phase_range)
+				{
+					const std::uint64_t phase = (b + k) % num_blocks;
+					// the rows of block phase of A which belong to the columns of
+					// block b, they end up in the rows of block b of B which belong
+					// to the columns of block phase
+					const std::uint64_t rows = blocks.width(b);
+					const std::uint64_t cols = blocks.width(phase);
+					const std::uint64_t B_offset = blocks.start(phase) * rows;
+					// Perform matrix transposition locally
+					if (blocks_start <= phase && phase < blocks_end) {
+						phase_futures.push_back(
+							hpx::async(&transpose_local
+								, A.local(phase - blocks_start).data()
+								, blocks.start(b) * cols
+								, B.local(b - blocks_start).data()
+								, B_offset
+								, rows
+								, cols
+								, tile_size
+							)
+						);
+					}
+					// receive only the remote tile into the next receive buffer,
+					// once that is free, and then transpose it; the received tile
+					// starts at offset 0
+					else {
+						const std::uint64_t slot = remote_phases++ % pipeline_depth;
+						sub_block recv = recv_buffers[
+							(b - blocks_start) * pipeline_depth + slot];
+						const std::size_t op =
+							fetch_ops[(b - blocks_start) * num_blocks + phase];
+
+						hpx::future<void> fetched;
+						if (buffer_free[slot].is_ready()) {
+							fetched = fetches.execute(op);
+						}
+						else {
+							fetched = buffer_free[slot].then(
+								[&fetches, op](hpx::shared_future<void>)
+								{
+									return fetches.execute(op);
+								});
+						}
+
+						buffer_free[slot] = hpx::dataflow(
+								&transpose
+								, std::move(fetched)
+								, recv
+								, std::uint64_t(0)
+								, B.local(b - blocks_start).data()
+								, B_offset
+								, rows
+								, cols
+								, tile_size
+							);
+						phase_futures.push_back(buffer_free[slot]);
+					}
 				}
+
+				block_futures[b - blocks_start] =
+					hpx::when_all(phase_futures);
 			}
+			);
 
-			block_futures[b - blocks_start] =
-				hpx::when_all(phase_futures);
+			hpx::wait_all(block_futures);
 		}
-		);
-
-		hpx::wait_all(block_futures);
 
 		double elapsed = t.elapsed();
 
@@ -220,7 +378,7 @@ void run_matrix_transposition(boost::program_options::variables_map& vm) {
 		}
 
 		if (root)
-			errsq += test_results(order, block_order, B, blocks_start, blocks_end);
+			errsq += test_results(blocks, B, blocks_start, blocks_end);
 	} // end of iter loop
 
 	double epsilon = 1.e-8;
@@ -250,85 +408,31 @@ void run_matrix_transposition(boost::program_options::variables_map& vm) {
 	}
 }
 
-void transpose(hpx::future<std::vector<double> > Af, std::uint64_t A_offset,
-	dist_object::dist_object<double>& B_temp, std::uint64_t B_offset, std::uint64_t block_size,
-	std::uint64_t block_order, std::uint64_t tile_size)
+void transpose(hpx::future<void> Af, sub_block A_buffer, std::uint64_t A_offset,
+	sub_block B_block, std::uint64_t B_offset,
+	std::uint64_t rows, std::uint64_t cols, std::uint64_t tile_size)
 {
-	std::vector<double> A_temp = Af.get();
-	const sub_block A(&(A_temp[A_offset]));
-	sub_block B(&((*B_temp)[B_offset]));
-
-	if (tile_size < block_order)
-	{
-		for (std::uint64_t i = 0; i < block_order; i += tile_size)
-		{
-			for (std::uint64_t j = 0; j < block_order; j += tile_size)
-			{
-				std::uint64_t max_i = (std::min)(block_order, i + tile_size);
-				std::uint64_t max_j = (std::min)(block_order, j + tile_size);
-
-				for (std::uint64_t it = i; it != max_i; ++it)
-				{
-					for (std::uint64_t jt = j; jt != max_j; ++jt)
-					{
-						B[it + block_order * jt] = A[jt + block_order * it];
-					}
-				}
-			}
-		}
-	}
-	else
-	{
-		for (std::uint64_t i = 0; i != block_order; ++i)
-		{
-			for (std::uint64_t j = 0; j != block_order; ++j)
-			{
-				B[i + block_order * j] = A[j + block_order * i];
-			}
-		}
-	}
+	Af.get();
+	transpose_local(A_buffer, A_offset, B_block, B_offset, rows, cols,
+		tile_size);
 }
 
-void transpose_local(dist_object::dist_object<double>& A_temp, std::uint64_t A_offset,
-	dist_object::dist_object<double>& B_temp, std::uint64_t B_offset,
-	std::uint64_t block_size, std::uint64_t block_order, std::uint64_t tile_size)
+void transpose_local(sub_block A_block, std::uint64_t A_offset,
+	sub_block B_block, std::uint64_t B_offset,
+	std::uint64_t rows, std::uint64_t cols, std::uint64_t tile_size)
 {
-	const sub_block A(&((*A_temp)[A_offset]));
-	sub_block B(&((*B_temp)[B_offset]));
+	const sub_block A(A_block + A_offset);
+	sub_block B(B_block + B_offset);
 
-	if (tile_size < block_order)
-	{
-		for (std::uint64_t i = 0; i < block_order; i += tile_size)
-		{
-			for (std::uint64_t j = 0; j < block_order; j += tile_size)
-			{
-				std::uint64_t max_i = (std::min)(block_order, i + tile_size);
-				std::uint64_t max_j = (std::min)(block_order, j + tile_size);
-
-				for (std::uint64_t it = i; it != max_i; ++it)
-				{
-					for (std::uint64_t jt = j; jt != max_j; ++jt)
-					{
-						B[it + block_order * jt] = A[jt + block_order * it];
-					}
-				}
-			}
-		}
-	}
+	if (cache_oblivious)
+		dist_object::kernels::transpose_recursive(A, cols, B, rows, rows, cols);
 	else
-	{
-		for (std::uint64_t i = 0; i != block_order; ++i)
-		{
-			for (std::uint64_t j = 0; j != block_order; ++j)
-			{
-				B[i + block_order * j] = A[j + block_order * i];
-			}
-		}
-	}
+		dist_object::kernels::transpose(A, cols, B, rows, rows, cols,
+			tile_size);
 }
 
-double test_results(std::uint64_t order, std::uint64_t block_order,
-	std::vector<dist_object::dist_object<double>> & trans, std::uint64_t blocks_start,
+double test_results(column_blocks const& blocks,
+	dist_object::dist_object_array<double> & trans, std::uint64_t blocks_start,
 	std::uint64_t blocks_end)
 {
 	using hpx::parallel::transform_reduce;
@@ -341,15 +445,16 @@ double test_results(std::uint64_t order, std::uint64_t block_order,
 			[](double lhs, double rhs) { return lhs + rhs; },
 			[&](std::uint64_t b) -> double
 	{
-		sub_block trans_block = &((*(trans[b]))[0]);
+		sub_block trans_block = trans.local(b - blocks_start).data();
+		const std::uint64_t width = blocks.width(b);
 		double errsq = 0.0;
-		for (std::uint64_t i = 0; i < order; ++i)
+		for (std::uint64_t i = 0; i < blocks.order; ++i)
 		{
 			double col_val = COL_SHIFT * i;
-			for (std::uint64_t j = 0; j < block_order; ++j)
+			for (std::uint64_t j = 0; j < width; ++j)
 			{
-				double diff = trans_block[i * block_order + j] -
-					(col_val + ROW_SHIFT * (b * block_order + j));
+				double diff = trans_block[i * width + j] -
+					(col_val + ROW_SHIFT * (blocks.start(b) + j));
 				errsq += diff * diff;
 			}
 		}
@@ -380,11 +485,22 @@ int main(int argc, char *argv[])
 			("iterations", value<std::uint64_t>()->default_value(1),
 				"# iterations")
 				("tile_size", value<std::uint64_t>(),
-					"Number of tiles to divide the individual matrix blocks for improved "
-					"cache and TLB performance")
+					"Size of the tiles the individual matrix blocks are transposed "
+					"in, chosen from the cache sizes if not given")
+					("cache_oblivious",
+						"Transpose the matrix blocks recursively instead of in "
+						"tiles, ignores tile_size")
 					("num_blocks", value<std::uint64_t>()->default_value(1),
 						"Number of blocks to divide the individual matrix blocks for "
 						"improved cache and TLB performance")
+						("pipeline_depth", value<std::uint64_t>()->default_value(0),
+							"Number of remote tiles per block which are received or "
+							"waiting to be transposed at the same time, all of them "
+							"if 0")
+						("all_to_all",
+							"Exchange the tiles with a single dist_object::all_to_all "
+							"and transpose them once all arrived, requires "
+							"num_blocks = 1")
 						("verbose", "Verbose output")
 		;
 
@@ -0,0 +1,261 @@
+//  Copyright (c) 2019 Weile Wei
+//  Copyright (c) 2019 Maxwell Reesser
+//  Copyright (c) 2019 Hartmut Kaiser
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#if !defined(HPX_TRANSPOSE_KERNEL_OCT_16_2019_0530PM)
+#define HPX_TRANSPOSE_KERNEL_OCT_16_2019_0530PM
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+// Out-of-place transposition of dense matrices stored row by row, shared by
+// the local and the remote phase of the transpose. The matrix is processed
+// in two levels of cache blocks: the outer ones are sized for the L2 cache,
+// the inner ones for the L1 cache, so the strided writes to the destination
+// stay within lines which are still cached. Inside the inner blocks, square
+// micro tiles are transposed in registers: 8x8 with AVX-512, 4x4 with AVX,
+// element by element otherwise. The instruction set is the one the code is
+// compiled for (e.g. -march=native).
+namespace dist_object {
+	namespace kernels {
+		namespace detail {
+			// Cache sizes in bytes, the defaults are typical for current
+			// x86 cores and used if the system does not report its own
+			inline std::size_t cache_size(int level)
+			{
+				long size = -1;
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+				size = sysconf(level == 1 ? _SC_LEVEL1_DCACHE_SIZE :
+					_SC_LEVEL2_CACHE_SIZE);
+#endif
+				if (size <= 0)
+					return level == 1 ? 32 * 1024 : 256 * 1024;
+				return static_cast<std::size_t>(size);
+			}
+
+			// Largest multiple of unit for which a source and a destination
+			// tile of tile x tile elements fill about half of the given cache
+			inline std::size_t tile_for(std::size_t cache_bytes,
+				std::size_t element_size, std::size_t unit)
+			{
+				std::size_t tile = static_cast<std::size_t>(std::sqrt(
+					static_cast<double>(cache_bytes) / (4.0 * element_size)));
+				return (std::max)(unit, tile / unit * unit);
+			}
+
+			template <typename T>
+			struct micro_tile
+			{
+				static constexpr std::size_t size = 4;
+
+				static void transpose(T const* a, std::size_t lda, T* b,
+					std::size_t ldb)
+				{
+					for (std::size_t i = 0; i != size; ++i)
+						for (std::size_t j = 0; j != size; ++j)
+							b[j * ldb + i] = a[i * lda + j];
+				}
+			};
+
+#if defined(__AVX512F__)
+			template <>
+			struct micro_tile<double>
+			{
+				static constexpr std::size_t size = 8;
+
+				static void transpose(double const* a, std::size_t lda,
+					double* b, std::size_t ldb)
+				{
+					__m512d r0 = _mm512_loadu_pd(a);
+					__m512d r1 = _mm512_loadu_pd(a + lda);
+					__m512d r2 = _mm512_loadu_pd(a + 2 * lda);
+					__m512d r3 = _mm512_loadu_pd(a + 3 * lda);
+					__m512d r4 = _mm512_loadu_pd(a + 4 * lda);
+					__m512d r5 = _mm512_loadu_pd(a + 5 * lda);
+					__m512d r6 = _mm512_loadu_pd(a + 6 * lda);
+					__m512d r7 = _mm512_loadu_pd(a + 7 * lda);
+
+					// interleave pairs of rows
+					__m512d t0 = _mm512_unpacklo_pd(r0, r1);
+					__m512d t1 = _mm512_unpackhi_pd(r0, r1);
+					__m512d t2 = _mm512_unpacklo_pd(r2, r3);
+					__m512d t3 = _mm512_unpackhi_pd(r2, r3);
+					__m512d t4 = _mm512_unpacklo_pd(r4, r5);
+					__m512d t5 = _mm512_unpackhi_pd(r4, r5);
+					__m512d t6 = _mm512_unpacklo_pd(r6, r7);
+					__m512d t7 = _mm512_unpackhi_pd(r6, r7);
+
+					// then 128 bit lanes of pairs of pairs
+					__m512d u0 = _mm512_shuffle_f64x2(t0, t2, 0x88);
+					__m512d u1 = _mm512_shuffle_f64x2(t1, t3, 0x88);
+					__m512d u2 = _mm512_shuffle_f64x2(t0, t2, 0xdd);
+					__m512d u3 = _mm512_shuffle_f64x2(t1, t3, 0xdd);
+					__m512d u4 = _mm512_shuffle_f64x2(t4, t6, 0x88);
+					__m512d u5 = _mm512_shuffle_f64x2(t5, t7, 0x88);
+					__m512d u6 = _mm512_shuffle_f64x2(t4, t6, 0xdd);
+					__m512d u7 = _mm512_shuffle_f64x2(t5, t7, 0xdd);
+
+					_mm512_storeu_pd(b, _mm512_shuffle_f64x2(u0, u4, 0x88));
+					_mm512_storeu_pd(b + ldb,
+						_mm512_shuffle_f64x2(u1, u5, 0x88));
+					_mm512_storeu_pd(b + 2 * ldb,
+						_mm512_shuffle_f64x2(u2, u6, 0x88));
+					_mm512_storeu_pd(b + 3 * ldb,
+						_mm512_shuffle_f64x2(u3, u7, 0x88));
+					_mm512_storeu_pd(b + 4 * ldb,
+						_mm512_shuffle_f64x2(u0, u4, 0xdd));
+					_mm512_storeu_pd(b + 5 * ldb,
+						_mm512_shuffle_f64x2(u1, u5, 0xdd));
+					_mm512_storeu_pd(b + 6 * ldb,
+						_mm512_shuffle_f64x2(u2, u6, 0xdd));
+					_mm512_storeu_pd(b + 7 * ldb,
+						_mm512_shuffle_f64x2(u3, u7, 0xdd));
+				}
+			};
+#elif defined(__AVX__)
+			template <>
+			struct micro_tile<double>
+			{
+				static constexpr std::size_t size = 4;
+
+				static void transpose(double const* a, std::size_t lda,
+					double* b, std::size_t ldb)
+				{
+					__m256d r0 = _mm256_loadu_pd(a);
+					__m256d r1 = _mm256_loadu_pd(a + lda);
+					__m256d r2 = _mm256_loadu_pd(a + 2 * lda);
+					__m256d r3 = _mm256_loadu_pd(a + 3 * lda);
+
+					__m256d t0 = _mm256_unpacklo_pd(r0, r1);
+					__m256d t1 = _mm256_unpackhi_pd(r0, r1);
+					__m256d t2 = _mm256_unpacklo_pd(r2, r3);
+					__m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+					_mm256_storeu_pd(b, _mm256_permute2f128_pd(t0, t2, 0x20));
+					_mm256_storeu_pd(b + ldb,
+						_mm256_permute2f128_pd(t1, t3, 0x20));
+					_mm256_storeu_pd(b + 2 * ldb,
+						_mm256_permute2f128_pd(t0, t2, 0x31));
+					_mm256_storeu_pd(b + 3 * ldb,
+						_mm256_permute2f128_pd(t1, t3, 0x31));
+				}
+			};
+#endif
+
+			// One inner block, the parts not covered by whole micro tiles are
+			// copied element by element
+			template <typename T>
+			void transpose_tile(T const* a, std::size_t lda, T* b,
+				std::size_t ldb, std::size_t rows, std::size_t cols)
+			{
+				std::size_t const m = micro_tile<T>::size;
+				std::size_t const full_rows = rows / m * m;
+				std::size_t const full_cols = cols / m * m;
+
+				for (std::size_t i = 0; i != full_rows; i += m) {
+					for (std::size_t j = 0; j != full_cols; j += m) {
+						micro_tile<T>::transpose(a + i * lda + j, lda,
+							b + j * ldb + i, ldb);
+					}
+					for (std::size_t it = i; it != i + m; ++it)
+						for (std::size_t j = full_cols; j != cols; ++j)
+							b[j * ldb + it] = a[it * lda + j];
+				}
+				for (std::size_t i = full_rows; i != rows; ++i)
+					for (std::size_t j = 0; j != cols; ++j)
+						b[j * ldb + i] = a[i * lda + j];
+			}
+		}
+
+		// Inner and outer block sizes in elements, derived from the cache
+		// sizes once. The inner one can be overridden, see transpose
+		template <typename T>
+		struct blocking
+		{
+			static std::size_t inner()
+			{
+				static std::size_t const tile = detail::tile_for(
+					detail::cache_size(1), sizeof(T),
+					detail::micro_tile<T>::size);
+				return tile;
+			}
+
+			static std::size_t outer()
+			{
+				static std::size_t const tile = (std::max)(inner(),
+					detail::tile_for(detail::cache_size(2), sizeof(T),
+						inner()));
+				return tile;
+			}
+		};
+
+		// Cache-oblivious variant of transpose: the larger dimension is
+		// halved recursively, so at some depth the pieces fit each level of
+		// the memory hierarchy, whatever its size. The splits are kept at
+		// multiples of the micro tile size, the leaves are a few micro tiles
+		// wide. Any shape is handled, there is nothing to tune
+		template <typename T>
+		void transpose_recursive(T const* a, std::size_t lda, T* b,
+			std::size_t ldb, std::size_t rows, std::size_t cols)
+		{
+			std::size_t const m = detail::micro_tile<T>::size;
+			if (rows <= 4 * m && cols <= 4 * m) {
+				detail::transpose_tile(a, lda, b, ldb, rows, cols);
+			}
+			else if (rows >= cols) {
+				std::size_t const half = rows / 2 / m * m;
+				transpose_recursive(a, lda, b, ldb, half, cols);
+				transpose_recursive(a + half * lda, lda, b + half, ldb,
+					rows - half, cols);
+			}
+			else {
+				std::size_t const half = cols / 2 / m * m;
+				transpose_recursive(a, lda, b, ldb, rows, half);
+				transpose_recursive(a + half, lda, b + half * ldb, ldb, rows,
+					cols - half);
+			}
+		}
+
+		// b = a^T, where a has rows x cols elements with a row stride of
+		// lda and b cols x rows elements with a row stride of ldb. tile
+		// replaces the inner block size if it is not zero
+		template <typename T>
+		void transpose(T const* a, std::size_t lda, T* b, std::size_t ldb,
+			std::size_t rows, std::size_t cols, std::size_t tile = 0)
+		{
+			std::size_t const inner = tile != 0 ? tile : blocking<T>::inner();
+			std::size_t const outer =
+				(std::max)(inner, blocking<T>::outer() / inner * inner);
+
+			for (std::size_t ii = 0; ii < rows; ii += outer) {
+				std::size_t const ii_end = (std::min)(rows, ii + outer);
+				for (std::size_t jj = 0; jj < cols; jj += outer) {
+					std::size_t const jj_end = (std::min)(cols, jj + outer);
+					for (std::size_t i = ii; i < ii_end; i += inner) {
+						std::size_t const i_end = (std::min)(ii_end, i + inner);
+						for (std::size_t j = jj; j < jj_end; j += inner) {
+							std::size_t const j_end =
+								(std::min)(jj_end, j + inner);
+							detail::transpose_tile(a + i * lda + j, lda,
+								b + j * ldb + i, ldb, i_end - i, j_end - j);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+#endif